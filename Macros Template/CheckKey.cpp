@@ -1,64 +1,89 @@
 #include "CheckKey.h"
 #include "Keys.h"
 
-bool CheckKey::VKDown(const RAWKEYBOARD& kbd, TCHAR vKey)
+//Message == WM_KEYDOWN / WM_KEYUP
+static bool IsKeyDown(const KbdEvent& kbd)
 {
-	return (kbd.VKey == vKey) && (kbd.Message == WM_KEYDOWN);
+	return kbd.down && !kbd.sys;
 }
-bool CheckKey::SCDown(const RAWKEYBOARD& kbd, WORD scanCode)
+static bool IsKeyUp(const KbdEvent& kbd)
 {
-	return (kbd.MakeCode == scanCode) && (kbd.Flags == RI_KEY_MAKE);
+	return !kbd.down && !kbd.sys;
 }
 
-bool CheckKey::VKRelease(const RAWKEYBOARD& kbd, TCHAR vKey)
+//Flags == RI_KEY_MAKE / RI_KEY_BREAK
+static bool IsMake(const KbdEvent& kbd)
 {
-	return (kbd.VKey == vKey) && (kbd.Message == WM_KEYUP);
+	return kbd.down && !kbd.E0 && !kbd.E1;
 }
-bool CheckKey::SCRelease(const RAWKEYBOARD& kbd, WORD scanCode)
+static bool IsBreak(const KbdEvent& kbd)
 {
-	return (kbd.MakeCode == scanCode) && (kbd.Flags == RI_KEY_BREAK);
+	return !kbd.down && !kbd.E0 && !kbd.E1;
 }
 
-bool CheckKey::VKComboDown(const RAWKEYBOARD& kbd, std::initializer_list<TCHAR> vKeys)
+bool CheckKey::KeyDown(const KbdEvent& kbd)
 {
-	if ((vKeys.size() != 0) && (kbd.VKey == *(vKeys.end() - 1)) && (kbd.Message == WM_KEYDOWN))
+	return IsKeyDown(kbd);
+}
+
+bool CheckKey::VKDown(const KbdEvent& kbd, VKey vKey)
+{
+	return (kbd.vKey == vKey) && IsKeyDown(kbd);
+}
+bool CheckKey::SCDown(const KbdEvent& kbd, ScanCode scanCode)
+{
+	return (kbd.makeCode == scanCode) && IsMake(kbd);
+}
+
+bool CheckKey::VKRelease(const KbdEvent& kbd, VKey vKey)
+{
+	return (kbd.vKey == vKey) && IsKeyUp(kbd);
+}
+bool CheckKey::SCRelease(const KbdEvent& kbd, ScanCode scanCode)
+{
+	return (kbd.makeCode == scanCode) && IsBreak(kbd);
+}
+
+bool CheckKey::VKComboDown(const KbdEvent& kbd, const Keys& keys, std::initializer_list<VKey> vKeys)
+{
+	if ((vKeys.size() != 0) && (kbd.vKey == *(vKeys.end() - 1)) && IsKeyDown(kbd))
 	{
 		for (auto it = vKeys.begin(), end = vKeys.end() - 1; it != end; ++it)
-			if (!(GetAsyncKeyState(*it) & 0x8000))
+			if (!keys.IsPressed(*it))
 				return false;
 		return true;
 	}
 	return false;
 }
-bool CheckKey::SCComboDown(const RAWKEYBOARD& kbd, std::initializer_list<WORD> sKeys)
+bool CheckKey::SCComboDown(const KbdEvent& kbd, const Keys& keys, std::initializer_list<ScanCode> sKeys)
 {
-	if ((sKeys.size() != 0) && (kbd.MakeCode == *(sKeys.end() - 1)) && (kbd.Flags == RI_KEY_BREAK))
+	if ((sKeys.size() != 0) && (Keys::ScanCodeOf(kbd) == *(sKeys.end() - 1)) && IsBreak(kbd))
 	{
 		for (auto it = sKeys.begin(), end = sKeys.end() - 1; it != end; ++it)
-			if (!(GetAsyncKeyState(Keys::ScanCodeToVirtualKey(*it)) & 0x8000))
+			if (!keys.IsPressedSC(*it))
 				return false;
 		return true;
 	}
 	return false;
 }
 
-bool CheckKey::VKComboDown(const RAWKEYBOARD& kbd, const std::vector<TCHAR>& vKeys)
+bool CheckKey::VKComboDown(const KbdEvent& kbd, const Keys& keys, const VKeyList& vKeys)
 {
-	if ((vKeys.size() != 0) && (kbd.VKey == *(vKeys.end() - 1)) && (kbd.Message == WM_KEYDOWN))
+	if ((vKeys.size() != 0) && (kbd.vKey == *(vKeys.end() - 1)) && IsKeyDown(kbd))
 	{
 		for (auto it = vKeys.begin(), end = vKeys.end() - 1; it != end; ++it)
-			if (!(GetAsyncKeyState(*it) & 0x8000))
+			if (!keys.IsPressed(*it))
 				return false;
 		return true;
 	}
 	return false;
 }
-bool CheckKey::SCComboDown(const RAWKEYBOARD& kbd, const std::vector<WORD>& sKeys)
+bool CheckKey::SCComboDown(const KbdEvent& kbd, const Keys& keys, const std::vector<ScanCode>& sKeys)
 {
-	if ((sKeys.size() != 0) && (kbd.MakeCode == *(sKeys.end() - 1)) && (kbd.Flags == RI_KEY_BREAK))
+	if ((sKeys.size() != 0) && (Keys::ScanCodeOf(kbd) == *(sKeys.end() - 1)) && IsBreak(kbd))
 	{
 		for (auto it = sKeys.begin(), end = sKeys.end() - 1; it != end; ++it)
-			if (!(GetAsyncKeyState(Keys::ScanCodeToVirtualKey(*it)) & 0x8000))
+			if (!keys.IsPressedSC(*it))
 				return false;
 		return true;
 	}
@@ -1,19 +1,25 @@
 #pragma once
-#include <Windows.h>
 #include <initializer_list>
 #include <vector>
+#include "Types.h"
+
+class Keys;
 
 namespace CheckKey
 {
-	bool VKDown(const RAWKEYBOARD& kbd, TCHAR vKey);
-	bool SCDown(const RAWKEYBOARD& kbd, WORD scanCode);
+	//Any key pressed, the same as a WM_KEYDOWN
+	bool KeyDown(const KbdEvent& kbd);
+
+	bool VKDown(const KbdEvent& kbd, VKey vKey);
+	bool SCDown(const KbdEvent& kbd, ScanCode scanCode);
 
-	bool VKRelease(const RAWKEYBOARD& kbd, TCHAR vKey);
-	bool SCRelease(const RAWKEYBOARD& kbd, WORD scanCode);
+	bool VKRelease(const KbdEvent& kbd, VKey vKey);
+	bool SCRelease(const KbdEvent& kbd, ScanCode scanCode);
 
-	bool VKComboDown(const RAWKEYBOARD& kbd, std::initializer_list<TCHAR> vKeys);
-	bool SCComboDown(const RAWKEYBOARD& kbd, std::initializer_list<WORD> sKeys);
+	//kbd presses the last key while the others are held in keys, which already saw kbd
+	bool VKComboDown(const KbdEvent& kbd, const Keys& keys, std::initializer_list<VKey> vKeys);
+	bool SCComboDown(const KbdEvent& kbd, const Keys& keys, std::initializer_list<ScanCode> sKeys);
 
-	bool VKComboDown(const RAWKEYBOARD& kbd, const std::vector<TCHAR>& vKeys);
-	bool SCComboDown(const RAWKEYBOARD& kbd, const std::vector<WORD>& sKeys);
+	bool VKComboDown(const KbdEvent& kbd, const Keys& keys, const VKeyList& vKeys);
+	bool SCComboDown(const KbdEvent& kbd, const Keys& keys, const std::vector<ScanCode>& sKeys);
 };
\ No newline at end of file
@@ -40,6 +40,15 @@ bool Event::WaitFor(uint32_t timeMilli)
 	return cv.wait_for(lock, std::chrono::milliseconds(timeMilli), [this] { return isSet; });
 }
 
+bool Event::WaitUntil(std::chrono::steady_clock::time_point time)
+{
+	std::unique_lock<std::mutex> lock{ mutex };
+	if (isSet)
+		return true;
+
+	return cv.wait_until(lock, time, [this] { return isSet; });
+}
+
 
 EventAutoReset::EventAutoReset(bool initialState)
 	:
@@ -95,5 +104,25 @@ bool EventAutoReset::WaitFor(uint32_t timeMilli)
 		return true;
 	}
 
+	return false;
+}
+
+bool EventAutoReset::WaitUntil(std::chrono::steady_clock::time_point time)
+{
+	std::unique_lock<std::mutex> lock{ mutex };
+	if (isSet)
+	{
+		if (--counter == 0)
+			isSet = false;
+		return true;
+	}
+
+	if (cv.wait_until(lock, time, [this] { return isSet; }))
+	{
+		if (--counter == 0)
+			isSet = false;
+		return true;
+	}
+
 	return false;
 }
\ No newline at end of file
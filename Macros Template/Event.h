@@ -1,6 +1,7 @@
 #pragma once
 #include <mutex>
 #include <condition_variable>
+#include <chrono>
 
 class Event
 {
@@ -10,6 +11,7 @@ public:
 	void Reset();
 	void Wait();
 	bool WaitFor(uint32_t timeMilli);
+	bool WaitUntil(std::chrono::steady_clock::time_point time);
 protected:
 	std::mutex mutex;
 	std::condition_variable cv;
@@ -24,6 +26,7 @@ public:
 	void Reset();
 	void Wait();
 	bool WaitFor(uint32_t timeMilli);
+	bool WaitUntil(std::chrono::steady_clock::time_point time);
 private:
 	uint32_t counter;
 };
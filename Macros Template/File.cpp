@@ -1,4 +1,6 @@
 #include "File.h"
+#include <algorithm>
+#include <fstream>
 
 std::vector<std::string> File::GetFileList(const std::string& dir, const std::vector<std::string>& dirSkipList)
 {
@@ -31,4 +33,54 @@ std::vector<std::string> File::GetFileList(const std::string& dir, const std::ve
 	}
 
 	return fileList;
+}
+
+std::vector<File::FileInfo> File::GetFileInfoList(const std::string& dir, const std::string& extension)
+{
+	std::vector<FileInfo> fileList;
+
+	std::error_code ec;
+	fs::recursive_directory_iterator it{ dir, ec }, end;
+	for (; !ec && (it != end); it.increment(ec))
+	{
+		if (!it->is_regular_file(ec) || (it->path().extension() != extension))
+			continue;
+
+		FileInfo info;
+		info.path = it->path().string();
+		info.size = (uint64_t)it->file_size(ec);
+		info.mtime = (int64_t)it->last_write_time(ec).time_since_epoch().count();
+		if (!ec)
+			fileList.push_back(std::move(info));
+		ec.clear();
+	}
+
+	return fileList;
+}
+
+bool File::ReadFile(const std::string& filename, std::vector<char>& data)
+{
+	std::ifstream stream(filename, std::ifstream::in | std::ifstream::binary | std::ifstream::ate);
+	if (!stream.is_open())
+		return false;
+
+	const std::streamoff size = stream.tellg();
+	if (size < 0)
+		return false;
+
+	data.resize((size_t)size);
+	stream.seekg(0);
+	stream.read(data.data(), size);
+	return !stream.fail();
+}
+
+bool File::WriteFile(const std::string& filename, const std::vector<char>& data)
+{
+	std::ofstream stream(filename, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+	if (!stream.is_open())
+		return false;
+
+	stream.write(data.data(), data.size());
+	stream.close();
+	return !stream.fail();
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <filesystem>
@@ -7,7 +8,21 @@ namespace fs = std::filesystem;
 
 namespace File
 {
+	struct FileInfo
+	{
+		std::string path;
+		uint64_t size = 0;
+		int64_t mtime = 0;	//Ticks of the filesystem clock, only meant to be compared for equality
+	};
+
 	std::vector<std::string> GetFileList(const std::string& dir, const std::vector<std::string>& dirSkipList = {});
+	//Regular files with the given extension, found recursively, with the size and write time
+	//the directory listing already provides
+	std::vector<FileInfo> GetFileInfoList(const std::string& dir, const std::string& extension);
+	//Reads the whole file with a single read
+	bool ReadFile(const std::string& filename, std::vector<char>& data);
+	//Replaces the file's contents with a single write
+	bool WriteFile(const std::string& filename, const std::vector<char>& data);
 }
 
 
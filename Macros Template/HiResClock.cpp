@@ -0,0 +1,31 @@
+#include "HiResClock.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+
+int64_t HiResClock::Now()
+{
+	static const int64_t freq = []()
+	{
+		LARGE_INTEGER f;
+		QueryPerformanceFrequency(&f);
+		return (int64_t)f.QuadPart;
+	}();
+
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+
+	//Split so the multiplication can't overflow after long uptimes
+	const int64_t c = counter.QuadPart;
+	return (c / freq) * 1000000000 + ((c % freq) * 1000000000) / freq;
+}
+#else
+#include <time.h>
+
+int64_t HiResClock::Now()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+#endif
\ No newline at end of file
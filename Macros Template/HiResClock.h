@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+
+//Monotonic high resolution time stamps in nanoseconds, QueryPerformanceCounter on Windows
+//and CLOCK_MONOTONIC elsewhere. Only differences between stamps are meaningful.
+class HiResClock
+{
+public:
+	static int64_t Now();
+
+	static int64_t ToMicro(int64_t nanos)
+	{
+		return nanos / 1000;
+	}
+};
\ No newline at end of file
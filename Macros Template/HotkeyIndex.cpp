@@ -0,0 +1,72 @@
+#include "HotkeyIndex.h"
+#include "CheckKey.h"
+#include "Keys.h"
+#include <algorithm>
+
+void HotkeyIndex::Clear()
+{
+	for (auto& it : triggers)
+	{
+		it.relevant.Reset();
+		it.exact.clear();
+		it.hotkeys.clear();
+	}
+	count = 0;
+}
+
+void HotkeyIndex::Add(const VKeyList& vKeys, int index)
+{
+	if (vKeys.empty())
+		return;
+
+	Hotkey hotkey;
+	for (auto it = vKeys.begin(), end = vKeys.end() - 1; it != end; ++it)
+		hotkey.held.Set(*it, true);
+	hotkey.nHeld = hotkey.held.Count();
+	hotkey.index = index;
+
+	Trigger& trigger = triggers[vKeys.back()];
+	if (!trigger.exact.emplace(hotkey.held, index).second)
+		return;
+
+	trigger.relevant |= hotkey.held;
+	const auto pos = std::upper_bound(trigger.hotkeys.begin(), trigger.hotkeys.end(), hotkey, [](const Hotkey& a, const Hotkey& b)
+	{
+		return a.nHeld > b.nHeld;
+	});
+	trigger.hotkeys.insert(pos, hotkey);
+	++count;
+}
+
+int HotkeyIndex::Find(const KbdEvent& kbd, const KeyMask& held) const
+{
+	if (!CheckKey::KeyDown(kbd))
+		return NONE;
+
+	const int index = Find(triggers[kbd.vKey], held);
+	const VKey sided = Keys::SidedVKey(kbd);
+	return ((index == NONE) && (sided != kbd.vKey)) ? Find(triggers[sided], held) : index;
+}
+
+int HotkeyIndex::Find(const Trigger& trigger, const KeyMask& held) const
+{
+	if (trigger.hotkeys.empty())
+		return NONE;
+
+	//Usually the keys held are exactly one combo's
+	const auto it = trigger.exact.find(held & trigger.relevant);
+	if (it != trigger.exact.end())
+		return it->second;
+
+	for (const auto& hotkey : trigger.hotkeys)
+	{
+		if (held.Contains(hotkey.held))
+			return hotkey.index;
+	}
+	return NONE;
+}
+
+size_t HotkeyIndex::GetCount() const
+{
+	return count;
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+#include <array>
+#include <unordered_map>
+#include <vector>
+#include "KeyMask.h"
+
+//Record toggle combos indexed by their trigger, the last key of the combo, with the keys that
+//have to be held compiled into masks. A key press is matched against the key state tracked
+//from the input stream, so no OS calls are made.
+class HotkeyIndex
+{
+public:
+	static constexpr int NONE = -1;
+
+	void Clear();
+	//Combos with an index already added for the same keys are ignored
+	void Add(const VKeyList& vKeys, int index);
+	//Index of the combo completed by kbd, the one with the most held keys if several are.
+	//held is the key state including kbd itself. Combos can hold or end with either the
+	//generic or the left or right key of a modifier.
+	int Find(const KbdEvent& kbd, const KeyMask& held) const;
+	size_t GetCount() const;
+private:
+	struct Hotkey
+	{
+		KeyMask held;
+		size_t nHeld;
+		int index;
+	};
+
+	struct Trigger
+	{
+		//Every key held by one of the hotkeys, the held state is reduced to it for exact lookups
+		KeyMask relevant;
+		std::unordered_map<KeyMask, int> exact;
+		//Most held keys first, searched when there is no exact match
+		std::vector<Hotkey> hotkeys;
+	};
+
+	std::array<Trigger, 256> triggers;
+	size_t count = 0;
+
+	int Find(const Trigger& trigger, const KeyMask& held) const;
+};
\ No newline at end of file
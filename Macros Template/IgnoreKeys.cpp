@@ -1,10 +1,10 @@
 #include "IgnoreKeys.h"
 #include <algorithm>
 
-Ignorekeys::KeyEntry::KeyEntry(WORD vKey, DWORD Message, bool oneTime)
+Ignorekeys::KeyEntry::KeyEntry(VKey vKey, bool down, bool oneTime)
 	:
 	vKey(vKey),
-	Message(Message),
+	down(down),
 	oneTime(oneTime)
 {}
 
@@ -18,13 +18,13 @@ void Ignorekeys::SetKeys(std::initializer_list<KeyEntry> ignoreList)
 	this->ignoreList = ignoreList;
 }
 
-bool Ignorekeys::KeyIgnored(const RAWKEYBOARD& kbd)
+bool Ignorekeys::KeyIgnored(const KbdEvent& kbd)
 {
 	if (ignoreList.empty())
 		return false;
 
 	auto it = std::find_if(ignoreList.begin(), ignoreList.end(), 
-		[&kbd](const KeyEntry& e) {return ((kbd.VKey == e.vKey) && (kbd.Message == e.Message)); });
+		[&kbd](const KeyEntry& e) {return ((kbd.vKey == e.vKey) && (kbd.down == e.down)); });
 
 	if ((it != ignoreList.end()))
 	{
@@ -1,16 +1,17 @@
 #pragma once
 #include <vector>
-#include <Windows.h>
+#include <initializer_list>
+#include "Types.h"
 
 class Ignorekeys
 {
 public:
 	struct KeyEntry
 	{
-		KeyEntry(WORD vKey, DWORD Message, bool oneTime);
+		KeyEntry(VKey vKey, bool down, bool oneTime);
 
-		WORD vKey;
-		DWORD Message;
+		VKey vKey;
+		bool down;
 		bool oneTime;
 	};
 
@@ -18,7 +19,7 @@ public:
 
 	void SetKeys(std::vector<KeyEntry> ignoreList);
 	void SetKeys(std::initializer_list<KeyEntry> ignoreList);
-	bool KeyIgnored(const RAWKEYBOARD& kbd);
+	bool KeyIgnored(const KbdEvent& kbd);
 private:
 	std::vector<KeyEntry> ignoreList;
 };
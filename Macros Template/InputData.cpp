@@ -1,201 +1,265 @@
 #include "InputData.h"
-#include "SimInp.h"
-#include "Keys.h"
-#include <thread>
-#include <chrono>
+#include "InputSink.h"
+#include <algorithm>
+#include <cstring>
 
-DelayData::DelayData(std::ifstream & is)
+template<typename T>
+static T ReadValue(const char*& data)
 {
-	ReadData(is);
+	T value;
+	std::memcpy(&value, data, sizeof(T));
+	data += sizeof(T);
+	return value;
 }
-DelayData::DelayData(DWORD delayMilli)
-	:
-	delayMilli(delayMilli)
-{}
-
-void DelayData::AddDelay(DWORD delay)
+template<typename T>
+static void WriteValue(char*& data, const T& value)
 {
-	delayMilli += delay;
+	std::memcpy(data, &value, sizeof(T));
+	data += sizeof(T);
 }
-void DelayData::ReadData(std::ifstream & is)
+
+//Files store each flag as a separate bool
+static uint8_t ReadFlag(const char*& data, uint8_t flag)
 {
-	is.read((char*)&delayMilli, sizeof(DWORD));
+	return (*data++ != 0) ? flag : 0;
 }
-void DelayData::SaveData(std::ostream& os) const
+static void WriteFlag(char*& data, const Input& input, uint8_t flag)
 {
-	os.write((const char*)&uuid, sizeof(int));
-	os.write((const char*)&delayMilli, sizeof(DWORD));
+	*data++ = (input.flags & flag) ? 1 : 0;
 }
-void DelayData::Simulate() const
+
+static Input MakeInput(int uuid, uint8_t flags = 0, uint16_t key = 0, int32_t x = 0, int32_t y = 0)
 {
-	std::this_thread::sleep_for(std::chrono::milliseconds(delayMilli));
+	Input input;
+	input.type = (uint8_t)uuid;
+	input.flags = flags;
+	input.key = key;
+	input.x = x;
+	input.y = y;
+	return input;
 }
 
-MouseClickData::MouseClickData(std::ifstream & is)
+Input DelayData::Make(uint32_t delayMicro)
 {
-	ReadData(is);
+	Input input = MakeInput(uuid);
+	input.delay = delayMicro;
+	return input;
 }
-
-MouseClickData::MouseClickData(bool down, bool left, bool right, bool middle)
-	:
-	down(down),
-	left(left),
-	right(right),
-	middle(middle)
-{}
-void MouseClickData::ReadData(std::ifstream& is)
+void DelayData::Decode(const char* data, Input& input)
 {
-	is.read((char*)&down, sizeof(bool));
-	is.read((char*)&left, sizeof(bool));
-	is.read((char*)&right, sizeof(bool));
-	is.read((char*)&middle, sizeof(bool));
+	input.delay = ReadValue<uint32_t>(data);
 }
-void MouseClickData::SaveData(std::ostream& os) const
+void DelayData::Encode(const Input& input, char* data)
 {
-	os.write((const char*)&uuid, sizeof(int));
-	os.write((const char*)&down, sizeof(bool));
-	os.write((const char*)&left, sizeof(bool));
-	os.write((const char*)&right, sizeof(bool));
-	os.write((const char*)&middle, sizeof(bool));
+	WriteValue(data, input.delay);
 }
-
-void MouseClickData::Simulate() const
+void DelayData::Simulate(const Input&, InputSink&)
 {
-	if (down)
-		SimInp::SendClickDown(left, right, middle);
-	else
-		SimInp::SendClickUp(left, right, middle);
+	//Delays are waited out by the Scheduler driving playback
 }
 
-MouseXClickData::MouseXClickData(std::ifstream& is)
+Input MouseClickData::Make(bool down, bool left, bool right, bool middle)
 {
-	ReadData(is);
+	return MakeInput(uuid, (down ? DOWN : 0) | (left ? LEFT : 0) | (right ? RIGHT : 0) | (middle ? MIDDLE : 0));
 }
-MouseXClickData::MouseXClickData(bool down, bool x1, bool x2)
-	:
-	down(down),
-	x1(x1),
-	x2(x2)
-{}
-
-void MouseXClickData::ReadData(std::ifstream& is)
+void MouseClickData::Decode(const char* data, Input& input)
 {
-	is.read((char*)&down, sizeof(bool));
-	is.read((char*)&x1, sizeof(bool));
-	is.read((char*)&x2, sizeof(bool));
+	input.flags = ReadFlag(data, DOWN);
+	input.flags |= ReadFlag(data, LEFT);
+	input.flags |= ReadFlag(data, RIGHT);
+	input.flags |= ReadFlag(data, MIDDLE);
 }
-void MouseXClickData::SaveData(std::ostream & os)const
+void MouseClickData::Encode(const Input& input, char* data)
 {
-	os.write((char*)&uuid, sizeof(int));
-	os.write((char*)&down, sizeof(bool));
-	os.write((char*)&x1, sizeof(bool));
-	os.write((char*)&x2, sizeof(bool));
+	WriteFlag(data, input, DOWN);
+	WriteFlag(data, input, LEFT);
+	WriteFlag(data, input, RIGHT);
+	WriteFlag(data, input, MIDDLE);
+}
+void MouseClickData::Simulate(const Input& input, InputSink& sink)
+{
+	sink.SendClick(input.flags & DOWN, input.flags & LEFT, input.flags & RIGHT, input.flags & MIDDLE);
 }
 
-void MouseXClickData::Simulate() const
+Input MouseXClickData::Make(bool down, bool x1, bool x2)
+{
+	return MakeInput(uuid, (down ? DOWN : 0) | (x1 ? X1 : 0) | (x2 ? X2 : 0));
+}
+void MouseXClickData::Decode(const char* data, Input& input)
+{
+	input.flags = ReadFlag(data, DOWN);
+	input.flags |= ReadFlag(data, X1);
+	input.flags |= ReadFlag(data, X2);
+}
+void MouseXClickData::Encode(const Input& input, char* data)
 {
-	if (down)
-		SimInp::SendXClickDown(x1, x2);
-	else
-		SimInp::SendXClickUp(x1, x2);
+	WriteFlag(data, input, DOWN);
+	WriteFlag(data, input, X1);
+	WriteFlag(data, input, X2);
+}
+void MouseXClickData::Simulate(const Input& input, InputSink& sink)
+{
+	sink.SendXClick(input.flags & DOWN, input.flags & X1, input.flags & X2);
 }
 
-MouseMoveData::MouseMoveData(std::ifstream& is)
+Input MouseMoveData::Make(int x, int y, bool absolute)
+{
+	return MakeInput(uuid, absolute ? ABSOLUTE : 0, 0, x, y);
+}
+void MouseMoveData::Decode(const char* data, Input& input)
+{
+	input.x = ReadValue<int32_t>(data);
+	input.y = ReadValue<int32_t>(data);
+	input.flags = ReadFlag(data, ABSOLUTE);
+}
+void MouseMoveData::Encode(const Input& input, char* data)
 {
-	ReadData(is);
+	WriteValue(data, input.x);
+	WriteValue(data, input.y);
+	WriteFlag(data, input, ABSOLUTE);
+}
+void MouseMoveData::Simulate(const Input& input, InputSink& sink)
+{
+	sink.SendMousePosition(input.x, input.y, input.flags & ABSOLUTE);
 }
-MouseMoveData::MouseMoveData(int x, int y, bool absolute)
-	:
-	x(x),
-	y(y),
-	absolute(absolute)
-{}
 
-void MouseMoveData::ReadData(std::ifstream& is)
+Input MouseScrollData::Make(int nClicks)
+{
+	return MakeInput(uuid, 0, 0, nClicks);
+}
+void MouseScrollData::Decode(const char* data, Input& input)
+{
+	input.x = ReadValue<int32_t>(data);
+}
+void MouseScrollData::Encode(const Input& input, char* data)
 {
-	is.read((char*)&x, sizeof(int));
-	is.read((char*)&y, sizeof(int));
-	is.read((char*)&absolute, sizeof(bool));
+	WriteValue(data, input.x);
 }
-void MouseMoveData::SaveData(std::ostream& os) const
+void MouseScrollData::Simulate(const Input& input, InputSink& sink)
 {
-	os.write((const char*)&uuid, sizeof(int));
-	os.write((const char*)&x, sizeof(int));
-	os.write((const char*)&y, sizeof(int));
-	os.write((const char*)&absolute, sizeof(bool));
+	sink.SendMouseScroll(input.x);
 }
 
-void MouseMoveData::Simulate() const
+Input KbdData::Make(uint16_t key, bool down, bool sc, bool E0)
+{
+	return MakeInput(uuid, (down ? DOWN : 0) | (sc ? SC : 0) | (E0 ? KbdData::E0 : 0), key);
+}
+void KbdData::Decode(const char* data, Input& input)
+{
+	input.key = ReadValue<uint16_t>(data);
+	input.flags = ReadFlag(data, DOWN);
+	input.flags |= ReadFlag(data, SC);
+	input.flags |= ReadFlag(data, E0);
+}
+void KbdData::Encode(const Input& input, char* data)
+{
+	WriteValue(data, input.key);
+	WriteFlag(data, input, DOWN);
+	WriteFlag(data, input, SC);
+	WriteFlag(data, input, E0);
+}
+void KbdData::Simulate(const Input& input, InputSink& sink)
 {
-	SimInp::SendMousePosition(x, y, absolute);
+	sink.SendKbd(input.key, input.flags & DOWN, input.flags & SC, input.flags & E0);
 }
 
-MouseScrollData::MouseScrollData(std::ifstream& is)
+//Indexed by uuid, the legacy millisecond delay is converted by the loader and only has a size
+struct InputCodec
+{
+	size_t size;
+	void (*decode)(const char*, Input&);
+	void (*encode)(const Input&, char*);
+	void (*simulate)(const Input&, InputSink&);
+};
+
+template<typename T>
+static constexpr InputCodec MakeCodec()
 {
-	ReadData(is);
+	return { T::SIZE, &T::Decode, &T::Encode, &T::Simulate };
 }
 
-MouseScrollData::MouseScrollData(int nClicks)
-	:
-	nClicks(nClicks)
-{}
-void MouseScrollData::ReadData(std::ifstream& is)
+static constexpr InputCodec codecs[MAX_UUID + 1] =
 {
-	is.read((char*)&nClicks, sizeof(int));
+	{ DelayData::SIZE, nullptr, nullptr, nullptr },
+	MakeCodec<MouseClickData>(),
+	MakeCodec<MouseXClickData>(),
+	MakeCodec<MouseMoveData>(),
+	MakeCodec<MouseScrollData>(),
+	MakeCodec<KbdData>(),
+	MakeCodec<DelayData>()
+};
+
+size_t Input::GetDataSize(int uuid)
+{
+	return ((uuid >= 0) && (uuid <= MAX_UUID)) ? codecs[uuid].size : 0;
 }
-void MouseScrollData::SaveData(std::ostream& os) const
+bool Input::IsValid() const
 {
-	os.write((const char*)&uuid, sizeof(int));
-	os.write((const char*)&nClicks, sizeof(int));
+	return (type <= MAX_UUID) && codecs[type].decode;
 }
-
-void MouseScrollData::Simulate() const
+void Input::Decode(int uuid, const char* data)
 {
-	SimInp::SendMouseScroll(nClicks);
+	*this = Input();
+	type = (uint8_t)uuid;
+	codecs[uuid].decode(data, *this);
+}
+//v1 files keep every wait in a DelayData of its own
+static bool HasDelayData(const Input& input)
+{
+	return (input.type != DelayData::uuid) && (input.delay != 0);
 }
 
-KbdData::KbdData(std::ifstream& is)
+size_t Input::GetEncodedSize() const
 {
-	ReadData(is);
+	return (HasDelayData(*this) ? sizeof(int) + DelayData::SIZE : 0) + sizeof(int) + codecs[type].size;
 }
-KbdData::KbdData(WORD key, bool down, bool sc, bool E0)
-	:
-	key(key),
-	down(down),
-	sc(sc),
-	E0(E0)
-{}
+char* Input::Encode(char* data) const
+{
+	if (HasDelayData(*this))
+		data = DelayData::Make(delay).Encode(data);
 
-void KbdData::ReadData(std::ifstream& is)
+	const int uuid = type;
+	WriteValue(data, uuid);
+	codecs[type].encode(*this, data);
+	return data + codecs[type].size;
+}
+void Input::Simulate(InputSink& sink) const
 {
-	is.read((char*)&key, sizeof(WORD));
-	is.read((char*)&down, sizeof(bool));
-	is.read((char*)&sc, sizeof(bool));
-	is.read((char*)&E0, sizeof(bool));
+	codecs[type].simulate(*this, sink);
 }
-void KbdData::SaveData(std::ostream& os) const
+bool Input::AddDelay(uint32_t delay)
 {
-	os.write((const char*)&uuid, sizeof(int));
-	os.write((const char*)&key, sizeof(WORD));
-	os.write((const char*)&down, sizeof(bool));
-	os.write((const char*)&sc, sizeof(bool));
-	os.write((const char*)&E0, sizeof(bool));
+	if ((type != DelayData::uuid) || (delay > UINT32_MAX - this->delay))
+		return false;
+
+	this->delay += delay;
+	return true;
+}
+uint32_t Input::GetDelay() const
+{
+	return delay;
 }
 
-void KbdData::Simulate() const
+void Input::Append(std::vector<Input>& events, const Input& input)
 {
-	if (sc)
+	if (events.empty() || (events.back().type != DelayData::uuid) || (input.delay > UINT32_MAX - events.back().delay))
 	{
-		if (down)
-			SimInp::SendKbdDownSC(key, E0);
-		else
-			SimInp::SendKbdUpSC(key, E0);
+		events.push_back(input);
+		return;
 	}
-	else
+
+	const uint32_t delay = events.back().delay + input.delay;
+	events.back() = input;
+	events.back().delay = delay;
+}
+void Input::AppendDelay(std::vector<Input>& events, uint64_t delayMicro)
+{
+	while (delayMicro != 0)
 	{
-		if (down)
-			SimInp::SendKbdDown(key);
-		else
-			SimInp::SendKbdUp(key);
+		const uint32_t delay = (uint32_t)std::min<uint64_t>(delayMicro, UINT32_MAX);
+		if (events.empty() || !events.back().AddDelay(delay))
+			events.push_back(DelayData::Make(delay));
+
+		delayMicro -= delay;
 	}
 }
\ No newline at end of file
@@ -1,176 +1,187 @@
 #pragma once
-#include <fstream>
-#include <Windows.h>
-#include <variant>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+#include "Types.h"
+
+class InputSink;
+struct Input;
+
+//Highest uuid found in a record file
+static constexpr int MAX_UUID = 6;
+
+//The *Data classes are stateless codecs describing how each event type packs into an Input,
+//how it is decoded from and encoded to a record and how it is simulated.
+//
+//Every event carries the time to wait before it in Input::delay. DelayData is left for waits
+//that aren't followed by an event, like the end of a record, or too long for one event.
 
 class DelayData
 {
 public:
-	static constexpr int uuid = 0;
-	DelayData(std::ifstream& is);
-	DelayData(DWORD delayMilli = 0);
-
-	void AddDelay(DWORD delay);
-	void ReadData(std::ifstream& is);
-	void SaveData(std::ostream& os) const;
-	void Simulate() const;
-
-private:
-	DWORD delayMilli = 0;
+	static constexpr int uuid = 6;
+	//Bytes following the uuid in a record file
+	static constexpr size_t SIZE = 4;
+	//Delays in milliseconds as written by older versions, converted on load
+	static constexpr int uuidMilli = 0;
+
+	//A wait injecting nothing, in microseconds
+	static Input Make(uint32_t delayMicro);
+	static void Decode(const char* data, Input& input);
+	static void Encode(const Input& input, char* data);
+	static void Simulate(const Input& input, InputSink& sink);
 };
 
 class MouseClickData
 {
 public:
 	static constexpr int uuid = 1;
-	MouseClickData(std::ifstream& is);
-	MouseClickData(bool down, bool left, bool right, bool middle);
-	MouseClickData() = default;
-
-	void ReadData(std::ifstream& is);
-	void SaveData(std::ostream& os) const;
-	void Simulate() const;
-
-private:
-	bool down = false, left = false, right = false, middle = false;
+	//Bytes following the uuid in a record file
+	static constexpr size_t SIZE = 4;
+	enum Flags : uint8_t
+	{
+		DOWN	= 0x01,
+		LEFT	= 0x02,
+		RIGHT	= 0x04,
+		MIDDLE	= 0x08
+	};
+
+	static Input Make(bool down, bool left, bool right, bool middle);
+	static void Decode(const char* data, Input& input);
+	static void Encode(const Input& input, char* data);
+	static void Simulate(const Input& input, InputSink& sink);
 };
 
 class MouseXClickData
 {
 public:
 	static constexpr int uuid = 2;
-	MouseXClickData(std::ifstream& is);
-	MouseXClickData(bool down, bool x1, bool x2);
-	MouseXClickData() = default;
-
-	void ReadData(std::ifstream& is);
-	void SaveData(std::ostream& os) const;
-	void Simulate() const;
-
-private:
-	bool down = false, x1 = false, x2 = false;
+	//Bytes following the uuid in a record file
+	static constexpr size_t SIZE = 3;
+	enum Flags : uint8_t
+	{
+		DOWN	= 0x01,
+		X1		= 0x02,
+		X2		= 0x04
+	};
+
+	static Input Make(bool down, bool x1, bool x2);
+	static void Decode(const char* data, Input& input);
+	static void Encode(const Input& input, char* data);
+	static void Simulate(const Input& input, InputSink& sink);
 };
 
 class MouseMoveData
 {
 public:
 	static constexpr int uuid = 3;
-	MouseMoveData(std::ifstream& is);
-	MouseMoveData(int x, int y, bool absolute);
-	MouseMoveData() = default;
-
-	void ReadData(std::ifstream& is);
-	void SaveData(std::ostream& os) const;
-	void Simulate() const;
+	//Bytes following the uuid in a record file
+	static constexpr size_t SIZE = 9;
+	enum Flags : uint8_t
+	{
+		ABSOLUTE = 0x01
+	};
 
-private:
-	int x = 0, y = 0;
-	bool absolute = false;
+	static Input Make(int x, int y, bool absolute);
+	static void Decode(const char* data, Input& input);
+	static void Encode(const Input& input, char* data);
+	static void Simulate(const Input& input, InputSink& sink);
 };
 
 class MouseScrollData
 {
 public:
 	static constexpr int uuid = 4;
-	MouseScrollData(std::ifstream& is);
-	MouseScrollData(int nClicks);
-	MouseScrollData() = default;
-
-	void ReadData(std::ifstream& is);
-	void SaveData(std::ostream& os) const;
-	void Simulate() const;
-
-private:
-	int nClicks = 0;
+	//Bytes following the uuid in a record file
+	static constexpr size_t SIZE = 4;
+
+	//Clicks kept in x
+	static Input Make(int nClicks);
+	static void Decode(const char* data, Input& input);
+	static void Encode(const Input& input, char* data);
+	static void Simulate(const Input& input, InputSink& sink);
 };
 
 class KbdData
 {
 public:
 	static constexpr int uuid = 5;
-	KbdData(std::ifstream& is);
-	KbdData(WORD key, bool down, bool sc, bool E0);
-	KbdData() = default;
+	//Bytes following the uuid in a record file
+	static constexpr size_t SIZE = 5;
+	enum Flags : uint8_t
+	{
+		DOWN	= 0x01,
+		SC		= 0x02,
+		E0		= 0x04
+	};
+
+	static Input Make(uint16_t key, bool down, bool sc, bool E0);
+	static void Decode(const char* data, Input& input);
+	static void Encode(const Input& input, char* data);
+	static void Simulate(const Input& input, InputSink& sink);
+};
 
-	void ReadData(std::ifstream& is);
-	void SaveData(std::ostream& os) const;
-	void Simulate() const;
+//A recorded event of any type, packed so recordings can be copied around as plain memory.
+//Work is dispatched on type through a table of the codecs above.
+struct Input
+{
+	//Bytes following the uuid of an event in a record file, 0 for an unknown uuid
+	static size_t GetDataSize(int uuid);
+	//False for a type that can't be held in memory, like a corrupt type read from a file
+	bool IsValid() const;
+	//Decodes an event whose uuid was already read, data must hold GetDataSize(uuid) bytes
+	void Decode(int uuid, const char* data);
+	//Bytes written by Encode, the uuid included, and a DelayData for the event's delay
+	size_t GetEncodedSize() const;
+	//Writes the uuid and the fields as stored in a v1 record file, preceded by a DelayData if the
+	//event has a delay, and returns the end of the written bytes
+	char* Encode(char* data) const;
+	void Simulate(InputSink& sink) const;
+	//Returns false if this isn't a DelayData or the delay would overflow
+	bool AddDelay(uint32_t delay);
+	//Microseconds to wait before the event, since the previous one or the start of playback
+	uint32_t GetDelay() const;
+	int GetUUID() const
+	{
+		return type;
+	}
 
-private:
-	WORD key = 0;
-	bool down = false, sc = false, E0 = false;
+	//Adds an event to the end of a record. It takes over the delay of a DelayData it follows, so
+	//waits end up in the event after them instead of an entry of their own.
+	static void Append(std::vector<Input>& events, const Input& input);
+	//Adds a wait to the end of a record, kept in DelayData until an event is appended
+	static void AppendDelay(std::vector<Input>& events, uint64_t delayMicro);
+
+	uint8_t type = DelayData::uuid;
+	uint8_t flags = 0;
+	uint16_t key = 0;
+	uint32_t delay = 0;
+	int32_t x = 0, y = 0;
 };
 
-using InputData = std::variant<DelayData, MouseClickData, MouseXClickData, MouseMoveData, MouseScrollData, KbdData>;
-
-class Input
+//Contiguous run of events, owned by an InputHandler or mapped straight from a record file
+struct InputSpan
 {
-public:
-	Input() = default;
-	template<typename T>
-	Input(T&& _value)
-		:
-		data(std::move(_value))
-	{}
-
-	void ReadData(std::ifstream& is)
+	const Input* begin() const
 	{
-		auto read_data = [&](auto& _data)
-		{
-			_data.ReadData(is);
-		};
-
-		std::visit(read_data, data);
+		return data;
 	}
-	void SaveData(std::ostream& os) const
+	const Input* end() const
 	{
-		auto write_data = [&](const auto& _data)
-		{
-			_data.SaveData(os);
-		};
-
-		std::visit(write_data, data);
+		return data + size;
 	}
-	void Simulate() const
+	const Input& operator[](size_t i) const
 	{
-		auto simulate = [](const auto& _data)
-		{
-			_data.Simulate();
-		};
-
-		std::visit(simulate, data);
+		return data[i];
 	}
-	bool AddDelay(float _delay)
+	bool empty() const
 	{
-		auto add_delay = [&](auto& _data)
-		{
-			using type = std::decay_t<decltype(_data)>;
-			if constexpr (std::is_same_v<type, DelayData>)
-			{
-				_data.AddDelay(_delay);
-				return true;
-			}
-
-			return false;
-		};
-
-		return std::visit(add_delay, data);
+		return size == 0;
 	}
 
-	template<typename T, typename IfSame, typename IfNotSame>
-	void ConditionalCall(IfSame&& _ifsame, IfNotSame&& _ifnotsame)
-	{
-		auto call = [&](auto& _data)
-		{
-			using type = std::decay_t<decltype(_data)>;
-			if constexpr (std::is_same_v<type, T>)
-				_ifsame(_data);
-			else
-				_ifnotsame();
-		};
-
-		std::visit(call, data);
-	}
-private:
-	InputData data;
-};
\ No newline at end of file
+	const Input* data = nullptr;
+	size_t size = 0;
+};
+
+static_assert(std::is_trivially_copyable_v<Input>, "Input must stay trivially copyable");
+static_assert(sizeof(Input) == 16, "Input must stay packed");
\ No newline at end of file
@@ -1,201 +1,770 @@
 #include "InputHandler.h"
 #include "CheckKey.h"
+#include "HiResClock.h"
+#include "InputSink.h"
+#include "PathSimplifier.h"
+#include "File.h"
+#include "RecordFormat.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
 #include <sstream>
 
 InputHandler::InputHandler()
 	:
-	recording(false)
+	mappedOffset(0),
+	headerEventCount(0),
+	headerDuration(0),
+	headerOnly(false),
+	recording(false),
+	lastTimestamp(0),
+	motionPending(false),
+	motionX(0),
+	motionY(0),
+	motionStart(0),
+	motionLast(0),
+	formatVersion(RecordHeader::VERSION),
+	revision(1)
 {}
 
-InputHandler::InputHandler(const std::vector<TCHAR>& toggleVKeys)
+InputHandler::InputHandler(const VKeyList& toggleVKeys)
 	:
 	toggleVKeys(toggleVKeys),
-	recording(false)
+	mappedOffset(0),
+	headerEventCount(0),
+	headerDuration(0),
+	headerOnly(false),
+	recording(false),
+	lastTimestamp(0),
+	motionPending(false),
+	motionX(0),
+	motionY(0),
+	motionStart(0),
+	motionLast(0),
+	formatVersion(RecordHeader::VERSION),
+	revision(1)
 {}
 
-InputHandler::InputHandler(InputHandler&& ih) noexcept
-	:
-	toggleVKeys(std::move(ih.toggleVKeys)),
-	inputs(std::move(ih.inputs)),
-	recording(ih.recording)
+bool InputHandler::operator==(const VKeyList& vKeys) const
+{
+	if (vKeys.size() != toggleVKeys.size())
+		return false;
+
+	for (int i = 0, size = toggleVKeys.size(); i < size; ++i)
+	{
+		if (vKeys[i] != toggleVKeys[i])
+			return false;
+	}
+	return true;
+}
+
+InputHandler::~InputHandler()
+{
+	Cleanup();
+}
+
+void InputHandler::Cleanup()
+{
+	inputs.clear();
+	mapping.Close();
+	headerEventCount = 0;
+	headerDuration = 0;
+	headerOnly = false;
+	motionPending = false;
+	++revision;
+}
+
+void InputHandler::AddDelay(uint64_t delayMicro)
+{
+	if (delayMicro == 0)
+		return;
+
+	Input::AppendDelay(inputs, delayMicro);
+	++revision;
+}
+
+void InputHandler::AddDelayUntil(int64_t timestamp)
 {
-	memset(&ih, 0, sizeof(InputHandler));
+	FlushMotion();
+
+	//Differences of truncated stamps so rounding doesn't accumulate over many events
+	const int64_t delay = HiResClock::ToMicro(timestamp) - HiResClock::ToMicro(lastTimestamp);
+	if (delay > 0)
+	{
+		AddDelay((uint64_t)delay);
+		lastTimestamp = timestamp;
+	}
 }
 
-InputHandler& InputHandler::operator=(InputHandler&& ih) noexcept
+void InputHandler::AddRelativeMove(int x, int y, int64_t timestamp)
 {
-	if (this != &ih)
+	++motionStats.moves;
+	if (motionPending)
+	{
+		const int64_t span = HiResClock::ToMicro(timestamp) - HiResClock::ToMicro(motionStart);
+		const int64_t mergedX = motionX + x, mergedY = motionY + y;
+		const int64_t maxPixels = coalescing.maxPixels;
+		if (((coalescing.quantumMicro == 0) || (span <= coalescing.quantumMicro)) &&
+			((maxPixels == 0) || (mergedX * mergedX + mergedY * mergedY <= maxPixels * maxPixels)) &&
+			(mergedX >= INT32_MIN) && (mergedX <= INT32_MAX) && (mergedY >= INT32_MIN) && (mergedY <= INT32_MAX))
+		{
+			motionX = mergedX;
+			motionY = mergedY;
+			motionLast = timestamp;
+			return;
+		}
+	}
+
+	AddDelayUntil(timestamp);
+	if (!coalescing.enabled)
 	{
-		toggleVKeys = std::move(ih.toggleVKeys);
-		inputs = std::move(ih.inputs);
-		recording = ih.recording;
-		memset(&ih, 0, sizeof(InputHandler));
+		Add<MouseMoveData>(x, y, false);
+		++motionStats.recorded;
+		return;
 	}
-	return *this;
+
+	motionPending = true;
+	motionX = x;
+	motionY = y;
+	motionStart = motionLast = timestamp;
 }
 
+void InputHandler::FlushMotion()
+{
+	if (!motionPending)
+		return;
 
-bool InputHandler::operator==(const std::vector<TCHAR>& vKeys) const
+	motionPending = false;
+	AddDelayUntil(motionLast);
+	Add<MouseMoveData>((int)motionX, (int)motionY, false);
+	++motionStats.recorded;
+}
+
+void InputHandler::SetMotionCoalescing(const MotionCoalescing& coalescing)
 {
-	if (vKeys.size() != toggleVKeys.size())
+	FlushMotion();
+	this->coalescing = coalescing;
+}
+const InputHandler::MotionStats& InputHandler::GetMotionStats() const
+{
+	return motionStats;
+}
+
+bool InputHandler::SimplifyMotion(double tolerance)
+{
+	StopRecording();
+	const InputSpan events = GetEvents();
+	if (!std::all_of(events.begin(), events.end(), [](const Input& it) { return it.IsValid(); }))
 		return false;
 
-	for (int i = 0, size = toggleVKeys.size(); i < size; ++i)
+	//Copied first as a mapped record is closed by Cleanup
+	const std::vector<Input> source(events.begin(), events.end());
+	Cleanup();
+	motionStats = MotionStats();
+
+	//Positions of the current run relative to where it started and their times in microseconds
+	//from the start of the record, the first one being the start of the run
+	std::vector<PathSimplifier::Point> path;
+	std::vector<uint64_t> times;
+	PathSimplifier simplifier;
+	uint64_t time = 0, written = 0;
+
+	auto addUntil = [this, &written](uint64_t until)
 	{
-		if (vKeys[i] != toggleVKeys[i])
-			return false;
+		AddDelay(until - written);
+		written = until;
+	};
+	auto addRun = [&]()
+	{
+		const auto& kept = simplifier.Simplify(path.data(), path.size(), tolerance);
+		for (size_t i = 1; i < kept.size(); ++i)
+		{
+			int64_t x = path[kept[i]].x - path[kept[i - 1]].x, y = path[kept[i]].y - path[kept[i - 1]].y;
+			addUntil(times[kept[i]]);
+			while ((x != 0) || (y != 0))
+			{
+				const int32_t stepX = (int32_t)std::clamp<int64_t>(x, INT32_MIN, INT32_MAX);
+				const int32_t stepY = (int32_t)std::clamp<int64_t>(y, INT32_MIN, INT32_MAX);
+				Add<MouseMoveData>(stepX, stepY, false);
+				++motionStats.recorded;
+				x -= stepX;
+				y -= stepY;
+			}
+		}
+		path.clear();
+		times.clear();
+	};
+
+	for (const auto& it : source)
+	{
+		time += it.GetDelay();
+		if (it.GetUUID() == DelayData::uuid)
+		{
+			continue;
+		}
+		else if ((it.GetUUID() == MouseMoveData::uuid) && !(it.flags & MouseMoveData::ABSOLUTE))
+		{
+			if (path.empty())
+			{
+				path.emplace_back();
+				times.push_back(time);
+			}
+			path.push_back({ path.back().x + it.x, path.back().y + it.y });
+			times.push_back(time);
+			++motionStats.moves;
+		}
+		else
+		{
+			addRun();
+			addUntil(time);
+			Input input = it;
+			input.delay = 0;
+			Add(input);
+		}
 	}
+	addRun();
+	addUntil(time);
 	return true;
 }
 
-InputHandler::~InputHandler()
+bool InputHandler::Simulate(InputSink& sink, uint32_t moveRate)
 {
-	Cleanup();
+	Scheduler scheduler;
+	return Simulate(sink, scheduler, moveRate);
 }
 
-void InputHandler::Cleanup()
+bool InputHandler::Simulate(InputSink& sink, Scheduler& scheduler, uint32_t moveRate)
 {
-	inputs.clear();
+	StopRecording();
+	return GetPlan(sink, moveRate).Play(sink, scheduler);
 }
 
-void InputHandler::Simulate()
+const PlaybackPlan& InputHandler::GetPlan(const InputSink& sink, uint32_t moveRate)
+{
+	//Events up to a delay are due together and sent as one batch, so chords and a move
+	//followed by a click arrive together
+	if (!plan.IsBuilt(revision, moveRate))
+		plan.Build(GetEvents(), revision, moveRate);
+	plan.Compile(sink);
+	return plan;
+}
+
+bool InputHandler::SimulateRange(InputSink& sink, Scheduler& scheduler, uint64_t fromMicro, uint64_t toMicro, uint32_t moveRate)
 {
 	StopRecording();
+	return GetPlan(sink, moveRate).Play(sink, scheduler, fromMicro, toMicro);
+}
 
-	for (const auto& it : inputs)
-		it.Simulate();
+const Timeline& InputHandler::GetTimeline()
+{
+	if (!timeline.IsBuilt(revision))
+		timeline.Build(GetEvents(), revision);
+	return timeline;
+}
+
+size_t InputHandler::Seek(uint64_t timeMicro)
+{
+	return GetTimeline().Seek(timeMicro);
+}
+
+bool InputHandler::Trim(uint64_t fromMicro, uint64_t toMicro)
+{
+	StopRecording();
+	if (headerOnly || (fromMicro > toMicro))
+		return false;
+
+	const Timeline& timeline = GetTimeline();
+	const InputSpan events = GetEvents();
+	const size_t first = timeline.Seek(fromMicro), last = timeline.Seek(toMicro);
+	const uint64_t end = std::max(fromMicro, std::min(toMicro, timeline.GetDuration()));
+
+	//The first event waits from fromMicro instead of the previous event
+	std::vector<Input> kept;
+	kept.reserve(last - first + 1);
+	uint64_t time = fromMicro;
+	for (size_t i = first; i < last; ++i)
+	{
+		Input input = events[i];
+		input.delay = (uint32_t)(timeline.GetTime(i) - time);
+		time = timeline.GetTime(i);
+
+		if (input.GetUUID() == DelayData::uuid)
+			Input::AppendDelay(kept, input.delay);
+		else
+			Input::Append(kept, input);
+	}
+	Input::AppendDelay(kept, end - time);
+
+	//Cleanup closes a mapped record, so only once its events were copied
+	Cleanup();
+	inputs = std::move(kept);
+	return true;
 }
 
 bool InputHandler::Load(const char* filename)
 {
-	std::ifstream stream;
-	stream.open(filename, std::ifstream::in | std::ifstream::binary);
-	if (!stream.is_open() || stream.fail())
+	std::vector<char> data;
+	if (!File::ReadFile(filename, data))
+	{
+		Cleanup();
+		toggleVKeys.clear();
+		loadError = "can't read file";
 		return false;
+	}
 
-	int nKeys;
-	stream.read((char*)&nKeys, sizeof(int));
-	if (stream.fail())
+	return Decode(data.data(), data.size());
+}
+
+bool InputHandler::LoadHeader(const char* filename)
+{
+	Cleanup();
+	toggleVKeys.clear();
+	loadError.clear();
+
+	std::ifstream stream(filename, std::ifstream::in | std::ifstream::binary);
+	if (!stream.is_open())
+	{
+		loadError = "can't read file";
 		return false;
+	}
 
-	for (int i = 0; i < nKeys; i++)
+	char data[sizeof(RecordHeader)];
+	stream.read(data, sizeof(data));
+	const size_t size = (size_t)stream.gcount();
+	stream.clear();
+
+	if (RecordHeader::Matches(data, size))
 	{
-		TCHAR key;
-		stream.read((char*)&key, sizeof(TCHAR));
-		if (stream.fail())
-			return false;
+		if (size < sizeof(RecordHeader))
+			return LoadFailed(0, "truncated header");
+
+		RecordHeader header;
+		std::memcpy(&header, data, sizeof(RecordHeader));
+
+		stream.seekg(0, std::ifstream::end);
+		std::string error;
+		if (!header.Check((size_t)stream.tellg(), error))
+			return LoadFailed(0, error);
+
+		//A v2 count includes the delays that become part of the events once converted
+		toggleVKeys.assign(header.toggleKeys, header.toggleKeys + header.nToggleKeys);
+		headerEventCount = (header.version == RecordHeader::VERSION) ? header.eventCount : 0;
+		headerDuration = header.duration;
+		headerOnly = true;
+		formatVersion = header.version;
+		return true;
+	}
+
+	int nKeys;
+	if (size < sizeof(int))
+		return LoadFailed(0, "missing toggle key count");
+
+	std::memcpy(&nKeys, data, sizeof(int));
+	if (nKeys < 0)
+		return LoadFailed(0, "bad toggle key count " + std::to_string(nKeys));
 
-		toggleVKeys.push_back(key);
+	toggleVKeys.resize(nKeys);
+	stream.seekg(sizeof(int));
+	stream.read((char*)toggleVKeys.data(), nKeys);
+	if (stream.gcount() != nKeys)
+		return LoadFailed(sizeof(int), "truncated toggle keys");
+
+	headerOnly = true;
+	formatVersion = 1;
+	return true;
+}
+
+void InputHandler::SetHeader(const VKeyList& toggleVKeys, uint64_t eventCount, uint64_t durationMicro)
+{
+	Cleanup();
+	loadError.clear();
+	this->toggleVKeys = toggleVKeys;
+	headerEventCount = (size_t)eventCount;
+	headerDuration = durationMicro;
+	headerOnly = true;
+}
+
+bool InputHandler::Map(const char* filename)
+{
+	Cleanup();
+	toggleVKeys.clear();
+	loadError.clear();
+
+	if (!mapping.Open(filename))
+	{
+		loadError = "can't map file";
+		return false;
 	}
 
-	auto make_input = [&stream](int uuid)
+	const char* data = mapping.GetData();
+	const size_t size = mapping.GetSize();
+	if (!RecordHeader::Matches(data, size))
+		return LoadFailed(0, "not a v3 record");
+	if (size < sizeof(RecordHeader))
+		return LoadFailed(0, "truncated header");
+
+	RecordHeader header;
+	std::memcpy(&header, data, sizeof(RecordHeader));
+
+	std::string error;
+	if (!header.Check(size, error))
+		return LoadFailed(0, error);
+	if (header.version != RecordHeader::VERSION)
+		return LoadFailed(0, "not a v3 record");
+	//Events are played in place, so they have to be aligned in the mapping, which starts on a page
+	if (header.headerSize % alignof(Input) != 0)
+		return LoadFailed(0, "misaligned events, header size " + std::to_string(header.headerSize));
+
+	//Playing from the mapping needs the blocks back to back, as written by Encode
+	for (uint32_t i = 0; i < header.blockCount; ++i)
 	{
-		switch (uuid)
+		const size_t entryOffset = header.indexOffset + i * sizeof(RecordBlock);
+		RecordBlock block;
+		std::memcpy(&block, data + entryOffset, sizeof(RecordBlock));
+
+		const uint64_t first = uint64_t(i) * header.eventsPerBlock;
+		if ((block.offset != header.headerSize + first * sizeof(Input)) ||
+			(block.eventCount != std::min<uint64_t>(header.eventsPerBlock, header.eventCount - first)))
+			return LoadFailed(entryOffset, "blocks aren't contiguous");
+	}
+
+	toggleVKeys.assign(header.toggleKeys, header.toggleKeys + header.nToggleKeys);
+	mappedOffset = header.headerSize;
+	headerEventCount = header.eventCount;
+	headerDuration = header.duration;
+	formatVersion = RecordHeader::VERSION;
+	return true;
+}
+
+bool InputHandler::Decode(const char* data, size_t size)
+{
+	Cleanup();
+	toggleVKeys.clear();
+	loadError.clear();
+
+	return RecordHeader::Matches(data, size) ? DecodeBlocks(data, size) : DecodeV1(data, size);
+}
+
+bool InputHandler::DecodeV1(const char* data, size_t size)
+{
+	size_t pos = 0;
+
+	int nKeys;
+	if (size < sizeof(int))
+		return LoadFailed(pos, "missing toggle key count");
+
+	std::memcpy(&nKeys, data, sizeof(int));
+	pos += sizeof(int);
+	if ((nKeys < 0) || ((size_t)nKeys > size - pos))
+		return LoadFailed(pos, "bad toggle key count " + std::to_string(nKeys));
+
+	toggleVKeys.assign((const VKey*)(data + pos), (const VKey*)(data + pos + nKeys));
+	pos += nKeys;
+
+	//Every event is at least a uuid and a 4 byte field, so this never has to grow
+	inputs.reserve((size - pos) / (sizeof(int) + sizeof(uint32_t)));
+
+	while (pos < size)
+	{
+		if (size - pos < sizeof(int))
+			return LoadFailed(pos, "truncated event");
+
+		int uuid;
+		std::memcpy(&uuid, data + pos, sizeof(int));
+
+		const size_t dataSize = Input::GetDataSize(uuid);
+		if (dataSize == 0)
+			return LoadFailed(pos, "unknown event type " + std::to_string(uuid));
+		if (size - pos - sizeof(int) < dataSize)
+			return LoadFailed(pos, "truncated event");
+
+		const char* eventData = data + pos + sizeof(int);
+		if (uuid == DelayData::uuidMilli)
 		{
-		case DelayData::uuid:
-			return Input(DelayData{ stream });
-		case MouseClickData::uuid:
-			return Input(MouseClickData{ stream });
-		case MouseXClickData::uuid:
-			return Input(MouseXClickData{ stream });
-		case MouseMoveData::uuid:
-			return Input(MouseMoveData{ stream });
-		case MouseScrollData::uuid:
-			return Input(MouseScrollData{ stream });
-		case KbdData::uuid:
-			return Input(KbdData{ stream });
+			uint32_t delayMilli;
+			std::memcpy(&delayMilli, eventData, sizeof(uint32_t));
+			Input::AppendDelay(inputs, uint64_t(delayMilli) * 1000);
 		}
-	};
+		else
+		{
+			Input input;
+			input.Decode(uuid, eventData);
+			if (uuid == DelayData::uuid)
+				Input::AppendDelay(inputs, input.GetDelay());
+			else
+				Input::Append(inputs, input);
+		}
+
+		pos += sizeof(int) + dataSize;
+	}
 
-	while (!stream.eof())
+	formatVersion = 1;
+	return true;
+}
+
+bool InputHandler::DecodeBlocks(const char* data, size_t size)
+{
+	RecordHeader header;
+	if (size < sizeof(RecordHeader))
+		return LoadFailed(0, "truncated header");
+
+	std::memcpy(&header, data, sizeof(RecordHeader));
+
+	std::string error;
+	if (!header.Check(size, error))
+		return LoadFailed(0, error);
+
+	toggleVKeys.assign(header.toggleKeys, header.toggleKeys + header.nToggleKeys);
+	const bool converted = header.version != RecordHeader::VERSION;
+	if (converted)
+		inputs.reserve(header.eventCount);
+	else
+		inputs.resize(header.eventCount);
+
+	size_t decoded = 0;
+	for (uint32_t i = 0; i < header.blockCount; ++i)
 	{
-		int uuid;
-		stream.read((char*)&uuid, sizeof(int));
-		if (stream.fail())
-			return false;
+		const size_t entryOffset = header.indexOffset + i * sizeof(RecordBlock);
+		RecordBlock block;
+		std::memcpy(&block, data + entryOffset, sizeof(RecordBlock));
 
-		if ((uuid < 0) || (uuid > 5))
-			return false;
+		if ((block.eventCount > header.eventsPerBlock) || (block.eventCount > header.eventCount - decoded) ||
+			(block.offset < header.headerSize) || (block.offset > header.indexOffset) ||
+			((header.indexOffset - block.offset) / header.eventSize < block.eventCount))
+			return LoadFailed(entryOffset, "bad block " + std::to_string(i));
+
+		if (!converted)
+		{
+			Input* out = inputs.data() + decoded;
+			std::memcpy(out, data + block.offset, block.eventCount * sizeof(Input));
+			for (uint32_t j = 0; j < block.eventCount; ++j)
+			{
+				if (!out[j].IsValid())
+					return LoadFailed(block.offset + j * sizeof(Input), "unknown event type " + std::to_string(out[j].type));
+			}
+		}
+		else
+		{
+			//v2 waits are events of their own, folded into the event after them
+			for (uint32_t j = 0; j < block.eventCount; ++j)
+			{
+				RecordEventV2 event;
+				std::memcpy(&event, data + block.offset + j * sizeof(RecordEventV2), sizeof(RecordEventV2));
+
+				Input input;
+				input.type = event.type;
+				input.flags = event.flags;
+				input.key = event.key;
+				if (!input.IsValid())
+					return LoadFailed(block.offset + j * sizeof(RecordEventV2), "unknown event type " + std::to_string(event.type));
+
+				if (input.GetUUID() == DelayData::uuid)
+				{
+					Input::AppendDelay(inputs, (uint32_t)event.x);
+					continue;
+				}
+
+				input.x = event.x;
+				input.y = event.y;
+				Input::Append(inputs, input);
+			}
+		}
 
-		Add(make_input(uuid));
+		decoded += block.eventCount;
 	}
 
+	if (decoded != header.eventCount)
+		return LoadFailed(header.indexOffset, "block index is missing events");
+
+	formatVersion = header.version;
 	return true;
 }
+
+bool InputHandler::LoadFailed(size_t offset, const std::string& what)
+{
+	Cleanup();
+	toggleVKeys.clear();
+	loadError = "offset " + std::to_string(offset) + ": " + what;
+	return false;
+}
+
 bool InputHandler::Save(const char* filename)
 {
 	StopRecording();
 	if (!HasRecorded())
 		return false;
 
-	std::ofstream stream;
-	stream.open(filename, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
-	if (!stream.is_open() || stream.fail())
-		return false;
+	std::vector<char> data;
+	Encode(data);
 
-	const int nKeys = toggleVKeys.size();
-	stream.write((char*)&nKeys, sizeof(int));
-
-	for (const auto& it : toggleVKeys)
+	//The file written may be the one mapped, so the events are moved to memory before it's replaced
+	if (IsMapped())
 	{
-		stream.write((char*)&it, sizeof(TCHAR));
-		if (stream.fail())
-			return false;
+		const InputSpan events = GetEvents();
+		inputs.assign(events.begin(), events.end());
+		mapping.Close();
+		headerEventCount = 0;
+		headerDuration = 0;
+		++revision;
 	}
+	return File::WriteFile(filename, data);
+}
 
-	for (const auto& it : inputs)
+void InputHandler::Encode(std::vector<char>& data) const
+{
+	if (toggleVKeys.size() > RecordHeader::MAX_TOGGLE_KEYS)
+		EncodeV1(data);
+	else
+		EncodeV3(data);
+}
+
+void InputHandler::EncodeV1(std::vector<char>& data) const
+{
+	const InputSpan events = GetEvents();
+	const int nKeys = toggleVKeys.size();
+
+	size_t size = sizeof(int) + nKeys;
+	for (const auto& it : events)
+		size += it.GetEncodedSize();
+
+	data.resize(size);
+	char* out = data.data();
+	std::memcpy(out, &nKeys, sizeof(int));
+	out += sizeof(int);
+	std::memcpy(out, toggleVKeys.data(), nKeys);
+	out += nKeys;
+
+	for (const auto& it : events)
+		out = it.Encode(out);
+}
+
+void InputHandler::EncodeV3(std::vector<char>& data) const
+{
+	const InputSpan events = GetEvents();
+	const size_t eventCount = events.size;
+	const uint32_t blockCount = uint32_t((eventCount + RecordHeader::EVENTS_PER_BLOCK - 1) / RecordHeader::EVENTS_PER_BLOCK);
+
+	RecordHeader header {};
+	std::memcpy(header.magic, RecordHeader::MAGIC, sizeof(RecordHeader::MAGIC));
+	header.version = RecordHeader::VERSION;
+	header.headerSize = sizeof(RecordHeader);
+	header.eventSize = sizeof(Input);
+	header.eventsPerBlock = RecordHeader::EVENTS_PER_BLOCK;
+	header.eventCount = eventCount;
+	header.indexOffset = sizeof(RecordHeader) + eventCount * sizeof(Input);
+	header.blockCount = blockCount;
+	header.nToggleKeys = (uint8_t)toggleVKeys.size();
+	std::copy(toggleVKeys.begin(), toggleVKeys.end(), header.toggleKeys);
+
+	data.resize(header.indexOffset + blockCount * sizeof(RecordBlock));
+	std::memcpy(data.data() + sizeof(RecordHeader), events.data, eventCount * sizeof(Input));
+
+	uint64_t time = 0;
+	for (uint32_t i = 0; i < blockCount; ++i)
 	{
-		it.SaveData(stream);
-		if (stream.fail())
-		{
-			stream.close();
-			return false;
-		}
-	}
+		const size_t first = size_t(i) * RecordHeader::EVENTS_PER_BLOCK;
+		const size_t last = std::min(first + RecordHeader::EVENTS_PER_BLOCK, eventCount);
 
-	stream.close();
+		RecordBlock block {};
+		block.offset = sizeof(RecordHeader) + first * sizeof(Input);
+		block.startTime = time + events[first].GetDelay();
+		block.eventCount = uint32_t(last - first);
+		std::memcpy(data.data() + header.indexOffset + i * sizeof(RecordBlock), &block, sizeof(RecordBlock));
 
-	return true;
+		for (size_t j = first; j < last; ++j)
+			time += events[j].GetDelay();
+	}
+
+	header.duration = time;
+	std::memcpy(data.data(), &header, sizeof(RecordHeader));
 }
 
-Input* InputHandler::GetBack() const
+Input* InputHandler::GetBack()
 {
-	return (Input*)(!inputs.empty() ? &inputs.back() : nullptr);
+	++revision;
+	return !inputs.empty() ? &inputs.back() : nullptr;
 }
 
 void InputHandler::PopBack()
 {
 	inputs.pop_back();
+	++revision;
 }
 
 void InputHandler::StartRecording()
+{
+	StartRecording(HiResClock::Now());
+}
+void InputHandler::StartRecording(int64_t timestamp)
 {
 	Cleanup();
 	recording = true;
+	lastTimestamp = timestamp;
+	motionStats = MotionStats();
 }
 void InputHandler::StopRecording()
 {
+	FlushMotion();
 	recording = false;
 }
 
+bool InputHandler::IsMapped() const
+{
+	return mapping.IsOpen();
+}
 bool InputHandler::IsRecording() const
 {
 	return recording;
 }
 bool InputHandler::HasRecorded() const
 {
-	return !inputs.empty();
+	return GetEvents().size != 0;
+}
+bool InputHandler::CheckForToggle(const KbdEvent& kbd, const Keys& keys) const
+{
+	return CheckKey::VKComboDown(kbd, keys, toggleVKeys);
+}
+
+const VKeyList& InputHandler::GetToggleVKeys() const
+{
+	return toggleVKeys;
+}
+InputSpan InputHandler::GetEvents() const
+{
+	if (IsMapped())
+		return { (const Input*)(mapping.GetData() + mappedOffset), headerEventCount };
+
+	return { inputs.data(), inputs.size() };
+}
+uint64_t InputHandler::GetEventCount() const
+{
+	return (IsMapped() || headerOnly) ? headerEventCount : inputs.size();
+}
+uint64_t InputHandler::GetDuration() const
+{
+	if (IsMapped() || headerOnly)
+		return headerDuration;
+
+	uint64_t duration = 0;
+	for (const auto& it : inputs)
+		duration += it.GetDelay();
+	return duration;
+}
+int InputHandler::GetFormatVersion() const
+{
+	return formatVersion;
 }
-bool InputHandler::CheckForToggle(const RAWKEYBOARD& kbd) const
+const std::string& InputHandler::GetLoadError() const
 {
-	return CheckKey::VKComboDown(kbd, toggleVKeys);
+	return loadError;
 }
 
 std::string InputHandler::FormatVKeys()
 {
+	//Signed like the TCHAR keys of the original builds so existing file names stay the same
 	std::stringstream stream;
 	for (const auto c : toggleVKeys)
-		stream << int(c) << '+';
+		stream << int((signed char)c) << '+';
 
 	std::string str = stream.str();
 	str.pop_back();
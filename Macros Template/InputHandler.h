@@ -1,51 +1,169 @@
 #pragma once
 #include <vector>
 #include <memory>
+#include <string>
 #include "InputData.h"
+#include "Keys.h"
+#include "MappedFile.h"
+#include "PlaybackPlan.h"
+#include "Scheduler.h"
+#include "Timeline.h"
 
 class InputHandler
 {
 public:
+	//Merging of consecutive relative mouse moves while recording, off unless enabled. A merged
+	//move is recorded at the time of its last move, so the replayed cursor lags the recorded
+	//one by at most quantumMicro or maxPixels.
+	struct MotionCoalescing
+	{
+		bool enabled = false;
+		uint32_t quantumMicro = 8000;	//Longest time one merged move may span, 0 for no limit
+		uint32_t maxPixels = 0;			//Longest distance one merged move may cover, 0 for no limit
+	};
+
+	//Relative moves received and recorded since recording started, or read and written by the
+	//last SimplifyMotion
+	struct MotionStats
+	{
+		size_t moves = 0;
+		size_t recorded = 0;
+	};
+
 	InputHandler();
-	InputHandler(const std::vector<TCHAR>& toggleVKeys);
-	InputHandler(InputHandler&& ih) noexcept;
-	InputHandler& operator=(InputHandler&& ih) noexcept;
-	bool operator==(const std::vector<TCHAR>& vKeys) const;
+	InputHandler(const VKeyList& toggleVKeys);
+	InputHandler(InputHandler&& ih) noexcept = default;
+	InputHandler& operator=(InputHandler&& ih) noexcept = default;
+	bool operator==(const VKeyList& vKeys) const;
 
 	~InputHandler();
 
 	void Cleanup();
 
+	//Events take over the delays added before them, on top of their own
 	template<typename T, typename... Args>
 	void Add(Args&&... vals)
 	{
-		inputs.emplace_back(T{ std::forward<Args>(vals)... });
+		Input::Append(inputs, T::Make(std::forward<Args>(vals)...));
+		++revision;
 	}
 
-	template<typename T>
-	void Add(T&& val)
+	void Add(const Input& input)
 	{
-		inputs.push_back(std::move(val));
+		Input::Append(inputs, input);
+		++revision;
 	}
 
-	void Simulate();
+	//Delays are in microseconds, held in a DelayData until the next event is added
+	void AddDelay(uint64_t delayMicro);
+	//Adds the time since the previous call, or since recording started, as a delay.
+	//Records a pending merged move first, so call it before adding any other event.
+	void AddDelayUntil(int64_t timestamp);
+	//Adds a relative mouse move received at timestamp, merged with the previous ones if
+	//coalescing is enabled
+	void AddRelativeMove(int x, int y, int64_t timestamp);
+	void SetMotionCoalescing(const MotionCoalescing& coalescing);
+	const MotionStats& GetMotionStats() const;
+	//Replaces every run of relative mouse moves between other events with the fewest moves that
+	//stay within tolerance pixels of the recorded path, by Ramer-Douglas-Peucker. Each run still
+	//ends at the same position, so clicks land where they did, and the duration is unchanged.
+	//Fails without changing anything if the record holds an invalid event.
+	bool SimplifyMotion(double tolerance);
+
+	//Plays the record's plan, built on first use and again only after the record changed or is
+	//played at another moveRate. moveRate resamples mouse moves to at most that many per second,
+	//0 replays them as recorded.
+	bool Simulate(InputSink& sink, uint32_t moveRate = 0);
+	bool Simulate(InputSink& sink, Scheduler& scheduler, uint32_t moveRate = 0);
+	const PlaybackPlan& GetPlan(const InputSink& sink, uint32_t moveRate = 0);
+	//Plays the events due in [fromMicro, toMicro) and times them from fromMicro, found by binary
+	//search so starting late in a long record doesn't walk the events before
+	bool SimulateRange(InputSink& sink, Scheduler& scheduler, uint64_t fromMicro, uint64_t toMicro, uint32_t moveRate = 0);
+
+	//Time of every event, built on first use and again only after the record changed
+	const Timeline& GetTimeline();
+	//Index of the first event due at or after timeMicro
+	size_t Seek(uint64_t timeMicro);
+	//Keeps only the events due in [fromMicro, toMicro), the record then starts at fromMicro and
+	//ends at toMicro or its old end. Only the events kept are visited. Fails for a record listed
+	//without its events.
+	bool Trim(uint64_t fromMicro, uint64_t toMicro);
 
 	bool Load(const char* filename);
+	//Reads only the toggle keys, without any events, so a record can be listed before it is used
+	bool LoadHeader(const char* filename);
+	//Lists the record from its toggle keys, event count and duration as saved elsewhere, like
+	//a catalog, the same as if LoadHeader had read them
+	void SetHeader(const VKeyList& toggleVKeys, uint64_t eventCount, uint64_t durationMicro);
+	//Maps a v3 record and plays straight from the mapping instead of decoding it, only the
+	//header and block index are read up front. Fails for v1 and v2 records, which have to be
+	//loaded to convert their events, and for a header size that would leave the events misaligned.
+	bool Map(const char* filename);
+	//Decodes a whole record file held in memory, v1, v2 or v3
+	bool Decode(const char* data, size_t size);
+	//Serializes the whole record file into data, sized up front so it is written in one pass.
+	//Writes v3 unless the toggle combo is too long for its header.
+	void Encode(std::vector<char>& data) const;
 	bool Save(const char* filename);
 
-	Input* GetBack() const;
+	//The record counts as changed, as the event may be modified through the pointer
+	Input* GetBack();
 	void PopBack();
 
 	void StartRecording();
+	//Recording from a timestamp other than now, like events replayed from another record
+	void StartRecording(int64_t timestamp);
 	void StopRecording();
 
 	bool IsRecording() const;
+	bool IsMapped() const;
+	//True if there are events to play or save, recorded, loaded or mapped. False for a record
+	//only listed from its header.
 	bool HasRecorded() const;
-	bool CheckForToggle(const RAWKEYBOARD& kbd) const;
+	bool CheckForToggle(const KbdEvent& kbd, const Keys& keys) const;
+
+	const VKeyList& GetToggleVKeys() const;
+	//Recorded or loaded events, or the events of the mapped file
+	InputSpan GetEvents() const;
+	//Also known after LoadHeader for v3 records, 0 for older records that weren't loaded
+	uint64_t GetEventCount() const;
+	//Sum of all delays in microseconds, known in the same cases as the event count
+	uint64_t GetDuration() const;
+	//File format version of the last successful Load or Decode
+	int GetFormatVersion() const;
+	//Why the last Load or Decode failed, including the file offset for malformed records
+	const std::string& GetLoadError() const;
 
 	std::string FormatVKeys();
 private:
-	std::vector<TCHAR> toggleVKeys;
+	bool DecodeV1(const char* data, size_t size);
+	//v2 and v3, which only differ in their events
+	bool DecodeBlocks(const char* data, size_t size);
+	void EncodeV1(std::vector<char>& data) const;
+	void EncodeV3(std::vector<char>& data) const;
+	bool LoadFailed(size_t offset, const std::string& what);
+	void FlushMotion();
+
+	VKeyList toggleVKeys;
 	std::vector<Input> inputs;
+	MappedFile mapping;
+	size_t mappedOffset;
+	//From the v3 header when only it was read or the file is mapped
+	size_t headerEventCount;
+	uint64_t headerDuration;
+	bool headerOnly;
 	bool recording;
+	int64_t lastTimestamp;
+	MotionCoalescing coalescing;
+	MotionStats motionStats;
+	//Merged relative move not recorded yet
+	bool motionPending;
+	int64_t motionX, motionY;
+	int64_t motionStart, motionLast;
+	std::string loadError;
+	int formatVersion;
+	//Bumped by every change to the events, the plan is rebuilt when it no longer matches
+	uint64_t revision;
+	PlaybackPlan plan;
+	Timeline timeline;
 };
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include "InputQueue.h"
+
+InputQueue::InputQueue(Handler handler, size_t capacity)
+	:
+	ring(capacity),
+	handler(std::move(handler)),
+	waiting(false),
+	quit(false),
+	thrd(&InputQueue::Run, this)
+{}
+
+InputQueue::~InputQueue()
+{
+	quit = true;
+	wake.Set();
+	thrd.join();
+}
+
+bool InputQueue::Push(const RawEvent& e)
+{
+	const bool res = ring.Push(e);
+
+	//Only pay for the wake up when the processing thread went to sleep on an empty ring
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (waiting.load(std::memory_order_relaxed))
+		wake.Set();
+
+	return res;
+}
+
+void InputQueue::Run()
+{
+	RawEvent batch[BATCH_SIZE];
+
+	while (!quit)
+	{
+		const size_t count = ring.PopBatch(batch, BATCH_SIZE);
+		if (count != 0)
+		{
+			handler(batch, count);
+			continue;
+		}
+
+		waiting.store(true, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (ring.Empty() && !quit)
+			wake.WaitFor(100);
+		waiting.store(false, std::memory_order_relaxed);
+	}
+}
+
+uint64_t InputQueue::GetOverflowCount() const
+{
+	return ring.GetOverflowCount();
+}
+size_t InputQueue::GetHighWaterMark() const
+{
+	return ring.GetHighWaterMark();
+}
+size_t InputQueue::GetCapacity() const
+{
+	return ring.Capacity();
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <thread>
+#include "Types.h"
+#include "SpscRing.h"
+#include "Event.h"
+
+//Hands captured events from the capture thread to a processing thread. The capture side
+//only copies into a lock-free ring; the processing thread drains it in batches.
+class InputQueue
+{
+public:
+	using Handler = std::function<void(const RawEvent* events, size_t count)>;
+
+	static constexpr size_t DEFAULT_CAPACITY = 16384;
+	static constexpr size_t BATCH_SIZE = 256;
+
+	InputQueue(Handler handler, size_t capacity = DEFAULT_CAPACITY);
+	~InputQueue();
+
+	//Capture thread only
+	bool Push(const RawEvent& e);
+
+	uint64_t GetOverflowCount() const;
+	size_t GetHighWaterMark() const;
+	size_t GetCapacity() const;
+private:
+	void Run();
+
+	SpscRing<RawEvent> ring;
+	Handler handler;
+	EventAutoReset wake;
+	std::atomic<bool> waiting, quit;
+	std::thread thrd;
+};
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include "InputData.h"
+
+class PlaybackPlan;
+
+//Playback target for simulated input, SendInputSink injects into the desktop and MemorySink records
+class InputSink
+{
+public:
+	virtual ~InputSink() = default;
+
+	virtual bool SendKbd(uint16_t key, bool down, bool sc, bool E0) = 0;
+	virtual bool SendClick(bool down, bool left, bool right, bool middle) = 0;
+	virtual bool SendXClick(bool down, bool x1, bool x2) = 0;
+	//If absolute x and y are normalized coordinates from 0 to 65,535
+	virtual bool SendMousePosition(int x, int y, bool absolute) = 0;
+	virtual bool SendMouseScroll(int nClicks) = 0;
+
+	//Events due at the same instant, sinks that can inject several events at once override this
+	//so they are injected together. False if not every event could be injected.
+	virtual bool SendBatch(const Input* inputs, size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+			inputs[i].Simulate(*this);
+		return true;
+	}
+
+	//Events converted ahead of playback into what a sink injects
+	class Compiled
+	{
+	public:
+		virtual ~Compiled() = default;
+	};
+
+	//Converts the events of every batch of plan in order, null if the sink has nothing to
+	//convert. The result may only depend on the type of the sink, it is reused by any sink of it.
+	virtual std::unique_ptr<Compiled> Compile(const PlaybackPlan&) const
+	{
+		return nullptr;
+	}
+	//Injects count events from first, an index into the events of a Compile result
+	virtual bool SendCompiled(const Compiled&, size_t, size_t)
+	{
+		return false;
+	}
+};
\ No newline at end of file
@@ -5,7 +5,7 @@ KeyComboRec::KeyComboRec()
 	recordType(NONE)
 {}
 
-void KeyComboRec::AddVKey(TCHAR key)
+void KeyComboRec::AddVKey(VKey key)
 {
 	//If no repeats add key
 	if (!HasRecorded() || (vKeys.back() != key))
@@ -26,7 +26,7 @@ void KeyComboRec::Stop()
 	recordType = NONE;
 }
 
-const std::vector<TCHAR>& KeyComboRec::GetVKeys() const
+const VKeyList& KeyComboRec::GetVKeys() const
 {
 	return vKeys;
 }
@@ -1,6 +1,5 @@
 #pragma once
-#include <vector>
-#include <tchar.h>
+#include "Types.h"
 
 class KeyComboRec
 {
@@ -13,15 +12,15 @@ public:
 	};
 	KeyComboRec();
 
-	void AddVKey(TCHAR key);
+	void AddVKey(VKey key);
 	void StartRecording();
 	void StartDeleting();
 	void Stop();
 
-	const std::vector<TCHAR>& GetVKeys() const;
+	const VKeyList& GetVKeys() const;
 	RecordType GetRecordType() const;
 	bool HasRecorded() const;
 private:
-	std::vector<TCHAR> vKeys;
+	VKeyList vKeys;
 	RecordType recordType;
 };
\ No newline at end of file
@@ -0,0 +1,97 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include "Types.h"
+
+//Set of virtual keys as a 256 bit mask, so testing whether a combo is held is a few word wide
+//ANDs instead of a lookup per key. Usable in constexpr tables.
+struct KeyMask
+{
+	static constexpr size_t nWords = 4;
+
+	constexpr KeyMask() = default;
+	constexpr KeyMask(std::initializer_list<VKey> vKeys)
+	{
+		for (const VKey vKey : vKeys)
+			Set(vKey, true);
+	}
+
+	constexpr void Set(VKey vKey, bool pressed)
+	{
+		const uint64_t bit = uint64_t(1) << (vKey & 63);
+		if (pressed)
+			words[vKey >> 6] |= bit;
+		else
+			words[vKey >> 6] &= ~bit;
+	}
+	constexpr bool Test(VKey vKey) const
+	{
+		return (words[vKey >> 6] >> (vKey & 63)) & 1;
+	}
+	//True if every key of mask is also in this one
+	constexpr bool Contains(const KeyMask& mask) const
+	{
+		return ((words[0] & mask.words[0]) == mask.words[0]) && ((words[1] & mask.words[1]) == mask.words[1]) &&
+			((words[2] & mask.words[2]) == mask.words[2]) && ((words[3] & mask.words[3]) == mask.words[3]);
+	}
+	constexpr bool Empty() const
+	{
+		return (words[0] | words[1] | words[2] | words[3]) == 0;
+	}
+	constexpr size_t Count() const
+	{
+		size_t count = 0;
+		for (uint64_t word : words)
+		{
+			for (; word != 0; word &= word - 1)
+				++count;
+		}
+		return count;
+	}
+	void Reset()
+	{
+		*this = KeyMask();
+	}
+
+	constexpr KeyMask operator&(const KeyMask& mask) const
+	{
+		KeyMask res;
+		for (size_t i = 0; i < nWords; ++i)
+			res.words[i] = words[i] & mask.words[i];
+		return res;
+	}
+	constexpr KeyMask& operator|=(const KeyMask& mask)
+	{
+		for (size_t i = 0; i < nWords; ++i)
+			words[i] |= mask.words[i];
+		return *this;
+	}
+	constexpr bool operator==(const KeyMask& mask) const
+	{
+		return (words[0] == mask.words[0]) && (words[1] == mask.words[1]) &&
+			(words[2] == mask.words[2]) && (words[3] == mask.words[3]);
+	}
+	constexpr bool operator!=(const KeyMask& mask) const
+	{
+		return !(*this == mask);
+	}
+
+	uint64_t words[nWords] {};
+};
+
+namespace std
+{
+	template<>
+	struct hash<KeyMask>
+	{
+		size_t operator()(const KeyMask& mask) const
+		{
+			uint64_t h = mask.words[0];
+			for (size_t i = 1; i < KeyMask::nWords; ++i)
+				h = (h ^ mask.words[i]) * 0x9E3779B97F4A7C15ull;
+			return size_t(h ^ (h >> 32));
+		}
+	};
+}
\ No newline at end of file
@@ -1,66 +1,138 @@
 #include "Keys.h"
 
-TCHAR Keys::CharToVirtualKey(TCHAR c)
+#ifdef _WIN32
+#include <Windows.h>
+
+VKey Keys::CharToVirtualKey(char c)
 {
 	return VkKeyScan(c) & 0xFF;
 }
-WORD Keys::VirtualKeyToScanCode(TCHAR vk)
+ScanCode Keys::VirtualKeyToScanCode(VKey vk)
 {
 	return MapVirtualKey(vk, MAPVK_VK_TO_VSC_EX);
 }
-WORD Keys::CharToScanCode(TCHAR c)
-{
-	return VirtualKeyToScanCode(CharToVirtualKey(c));
-}
-TCHAR Keys::ScanCodeToVirtualKey(WORD scan)
+VKey Keys::ScanCodeToVirtualKey(ScanCode scan)
 {
 	return MapVirtualKey(scan, MAPVK_VSC_TO_VK_EX);
 }
 
+#else
+
+//Set 1 scan code to virtual key table of a US layout, used where there is no keyboard layout to ask
+static constexpr VKey scanCodeTable[] =
+{
+	0x00, 0x1B, '1',  '2',  '3',  '4',  '5',  '6',  '7',  '8',  '9',  '0',  0xBD, 0xBB, 0x08, 0x09,
+	'Q',  'W',  'E',  'R',  'T',  'Y',  'U',  'I',  'O',  'P',  0xDB, 0xDD, 0x0D, 0xA2, 'A',  'S',
+	'D',  'F',  'G',  'H',  'J',  'K',  'L',  0xBA, 0xDE, 0xC0, 0xA0, 0xDC, 'Z',  'X',  'C',  'V',
+	'B',  'N',  'M',  0xBC, 0xBE, 0xBF, 0xA1, 0x6A, 0xA4, 0x20, 0x14, 0x70, 0x71, 0x72, 0x73, 0x74,
+	0x75, 0x76, 0x77, 0x78, 0x79, 0x90, 0x91, 0x24, 0x26, 0x21, 0x6D, 0x25, 0x0C, 0x27, 0x6B, 0x23,
+	0x28, 0x22, 0x2D, 0x2E, 0x2C, 0x00, 0xE2, 0x7A, 0x7B
+};
+static constexpr ScanCode scanCodeTableSize = sizeof(scanCodeTable) / sizeof(scanCodeTable[0]);
 
-void Keys::OnPress(unsigned char vKey)
+VKey Keys::CharToVirtualKey(char c)
 {
-	keyStates[vKey] = true;
+	if ((c >= 'a') && (c <= 'z'))
+		return VKey(c - 'a' + 'A');
+	if (((c >= 'A') && (c <= 'Z')) || ((c >= '0') && (c <= '9')) || (c == ' '))
+		return VKey(c);
+	return 0;
 }
-void Keys::OnRelease(unsigned char vKey)
+ScanCode Keys::VirtualKeyToScanCode(VKey vk)
 {
-	keyStates[vKey] = false;
+	if (vk == 0)
+		return 0;
+
+	for (ScanCode sc = 0; sc < scanCodeTableSize; ++sc)
+		if (scanCodeTable[sc] == vk)
+			return sc;
+	return 0;
 }
+VKey Keys::ScanCodeToVirtualKey(ScanCode scan)
+{
+	return (scan < scanCodeTableSize) ? scanCodeTable[scan] : 0;
+}
+
+#endif
 
-bool Keys::IsPressed(unsigned char vKey) const
+ScanCode Keys::CharToScanCode(char c)
 {
-	return keyStates[vKey];
+	return VirtualKeyToScanCode(CharToVirtualKey(c));
 }
-bool Keys::IsPressedCombo(std::initializer_list<TCHAR> vKeys)
+
+
+VKey Keys::SidedVKey(const KbdEvent& kbd)
 {
-	if (vKeys.size() != 0)
+	switch (kbd.vKey)
 	{
-		for(auto& k : vKeys)
-			if(!IsPressed(k))
-				return false;
-
-		return true;
+	case VK::SHIFT:
+		//Right shift has its own make code instead of an E0 prefix
+		return (kbd.makeCode == 0x36) ? VK::RSHIFT : VK::LSHIFT;
+	case VK::CONTROL:
+		return kbd.E0 ? VK::RCONTROL : VK::LCONTROL;
+	case VK::MENU:
+		return kbd.E0 ? VK::RMENU : VK::LMENU;
+	default:
+		return kbd.vKey;
 	}
-	return false;
 }
-bool Keys::IsPressedCombo(std::vector<TCHAR> vKeys)
+
+ScanCode Keys::ScanCodeOf(const KbdEvent& kbd)
 {
-	if (vKeys.size() != 0)
-	{
-		for (auto& k : vKeys)
-			if (!IsPressed(k))
-				return false;
+	return kbd.E0 ? ScanCode(0xE000 | (kbd.makeCode & 0xFF)) : ScanCode(kbd.makeCode & 0xFF);
+}
+size_t Keys::ScanIndex(ScanCode sc)
+{
+	return (sc & 0xFF) | ((sc & 0xFF00) ? 0x100 : 0);
+}
 
-		return true;
+void Keys::OnKey(const KbdEvent& kbd)
+{
+	scanStates[ScanIndex(ScanCodeOf(kbd))] = kbd.down;
+
+	const VKey sided = SidedVKey(kbd);
+	repeat = kbd.down && keyStates.Test(sided);
+	keyStates.Set(sided, kbd.down);
+	switch (sided)
+	{
+	case VK::LSHIFT:
+	case VK::RSHIFT:
+		keyStates.Set(VK::SHIFT, keyStates.Test(VK::LSHIFT) || keyStates.Test(VK::RSHIFT));
+		break;
+	case VK::LCONTROL:
+	case VK::RCONTROL:
+		keyStates.Set(VK::CONTROL, keyStates.Test(VK::LCONTROL) || keyStates.Test(VK::RCONTROL));
+		break;
+	case VK::LMENU:
+	case VK::RMENU:
+		keyStates.Set(VK::MENU, keyStates.Test(VK::LMENU) || keyStates.Test(VK::RMENU));
+		break;
 	}
-	return false;
 }
 
-bool Keys::IsPressedSC(unsigned char sc) const
+bool Keys::IsRepeat() const
+{
+	return repeat;
+}
+
+bool Keys::IsPressed(VKey vKey) const
+{
+	return keyStates.Test(vKey);
+}
+const KeyMask& Keys::GetState() const
+{
+	return keyStates;
+}
+bool Keys::IsPressedCombo(const KeyMask& vKeys) const
+{
+	return !vKeys.Empty() && keyStates.Contains(vKeys);
+}
+
+bool Keys::IsPressedSC(ScanCode sc) const
 {
-	return IsPressed(ScanCodeToVirtualKey(sc));
+	return scanStates[ScanIndex(sc)];
 }
-bool Keys::IsPressedComboSC(std::initializer_list<TCHAR> scs)
+bool Keys::IsPressedComboSC(std::initializer_list<ScanCode> scs) const
 {
 	if (scs.size() != 0)
 	{
@@ -72,7 +144,7 @@ bool Keys::IsPressedComboSC(std::initializer_list<TCHAR> scs)
 	}
 	return false;
 }
-bool Keys::IsPressedComboSC(std::vector<TCHAR> scs)
+bool Keys::IsPressedComboSC(const std::vector<ScanCode>& scs) const
 {
 	if (scs.size() != 0)
 	{
@@ -1,33 +1,50 @@
 #pragma once
-#include <Windows.h>
-#include <tchar.h>
 #include <bitset>
+#include <initializer_list>
 #include <vector>
+#include "KeyMask.h"
+#include "Types.h"
 
 class Keys
 {
 public:
-	friend class MainWindow;
-
 	Keys() = default;
 
-	static TCHAR CharToVirtualKey(TCHAR c);
-	static WORD CharToScanCode(TCHAR c);
+	static VKey CharToVirtualKey(char c);
+	static ScanCode CharToScanCode(char c);
+
+	static ScanCode VirtualKeyToScanCode(VKey vk);
+	static VKey ScanCodeToVirtualKey(ScanCode scan);
+
+	//LSHIFT/RSHIFT, LCONTROL/RCONTROL or LMENU/RMENU for a modifier, as raw input only
+	//reports SHIFT, CONTROL and MENU. vKey for any other key.
+	static VKey SidedVKey(const KbdEvent& kbd);
+	//The make code with 0xE000 added for an E0 prefixed key, as VirtualKeyToScanCode returns it
+	static ScanCode ScanCodeOf(const KbdEvent& kbd);
 
-	static WORD VirtualKeyToScanCode(TCHAR vk);
-	static TCHAR ScanCodeToVirtualKey(WORD scan);
+	//The only source of key state, fed every keyboard event of the raw input stream in order so
+	//combo checks never have to ask the OS and give the same result headless.
+	//Tracks both the generic and the left or right key of a modifier, the generic key is
+	//pressed while either side is.
+	void OnKey(const KbdEvent& kbd);
+	//The last event passed to OnKey was an auto repeat of a key already held
+	bool IsRepeat() const;
 
-	bool IsPressed(unsigned char vKey) const;
-	bool IsPressedCombo(std::initializer_list<TCHAR> vKeys);
-	bool IsPressedCombo(std::vector<TCHAR> vKeys);
+	bool IsPressed(VKey vKey) const;
+	//Every key pressed, as tracked from the keyboard events
+	const KeyMask& GetState() const;
+	//True if every key of the combo is pressed
+	bool IsPressedCombo(const KeyMask& vKeys) const;
 
-	bool IsPressedSC(unsigned char sc) const;
-	bool IsPressedComboSC(std::initializer_list<TCHAR> scs);
-	bool IsPressedComboSC(std::vector<TCHAR> scs);
+	//Scan codes as returned by ScanCodeOf
+	bool IsPressedSC(ScanCode sc) const;
+	bool IsPressedComboSC(std::initializer_list<ScanCode> scs) const;
+	bool IsPressedComboSC(const std::vector<ScanCode>& scs) const;
 private:
-	void OnPress(unsigned char vKey);
-	void OnRelease(unsigned char vKey);
+	//Make codes, E0 prefixed ones in the upper half
+	static size_t ScanIndex(ScanCode sc);
 
-	static constexpr unsigned int nKeys = 256u;
-	std::bitset<nKeys> keyStates;
+	KeyMask keyStates;
+	std::bitset<512> scanStates;
+	bool repeat = false;
 };
\ No newline at end of file
@@ -0,0 +1,648 @@
+#include "File.h"
+#include "HotkeyIndex.h"
+#include "InputHandler.h"
+#include "MemorySink.h"
+#include "PathSimplifier.h"
+#include "PlaybackPlan.h"
+#include "Player.h"
+#include "RecordCatalog.h"
+#include "RecordFormat.h"
+#include "RecordList.h"
+#include "Scheduler.h"
+#include "SequenceMatcher.h"
+#include "SpscRing.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+//Regression checks of the core library, run by ctest
+
+static int failures = 0;
+
+static void Check(bool condition, const std::string& what)
+{
+	if (!condition)
+	{
+		std::cerr << "FAILED: " << what << '\n';
+		++failures;
+	}
+}
+
+template<typename T>
+static void Write(std::vector<char>& data, const T& value)
+{
+	const char* bytes = (const char*)&value;
+	data.insert(data.end(), bytes, bytes + sizeof(T));
+}
+
+static bool Same(InputSpan events, const std::vector<Input>& expected)
+{
+	if (events.size != expected.size())
+		return false;
+
+	for (size_t i = 0; i < events.size; ++i)
+	{
+		const Input& a = events[i];
+		const Input& b = expected[i];
+		if ((a.type != b.type) || (a.flags != b.flags) || (a.key != b.key) || (a.delay != b.delay) || (a.x != b.x) || (a.y != b.y))
+			return false;
+	}
+	return true;
+}
+
+static Input WithDelay(Input input, uint32_t delay)
+{
+	input.delay = delay;
+	return input;
+}
+
+static const VKeyList toggle = { 17, 66 };
+
+//What both fixtures decode to, every wait folded into the event after it
+static const std::vector<Input> expected =
+{
+	WithDelay(KbdData::Make(0x1E, true, true, false), 2000),
+	WithDelay(MouseMoveData::Make(5, -3, false), 500),
+	WithDelay(MouseClickData::Make(true, true, false, false), 0),
+	WithDelay(MouseMoveData::Make(100, 200, true), 250),
+	WithDelay(KbdData::Make(0x1E, false, true, false), 70),
+	DelayData::Make(1000)
+};
+
+//v1: toggle keys and a stream of uuid + fields, with both the millisecond and the microsecond delay
+static std::vector<char> MakeV1()
+{
+	std::vector<char> data;
+	Write(data, (int)toggle.size());
+	data.insert(data.end(), toggle.begin(), toggle.end());
+
+	auto delayMilli = [&data](uint32_t milli)
+	{
+		Write(data, DelayData::uuidMilli);
+		Write(data, milli);
+	};
+	auto delay = [&data](uint32_t micro)
+	{
+		Write(data, DelayData::uuid);
+		Write(data, micro);
+	};
+	auto event = [&data](const Input& input)
+	{
+		std::vector<char> encoded(input.GetEncodedSize());
+		input.Encode(encoded.data());
+		data.insert(data.end(), encoded.begin(), encoded.end());
+	};
+
+	delayMilli(2);
+	event(KbdData::Make(0x1E, true, true, false));
+	delay(200);
+	delay(300);
+	event(MouseMoveData::Make(5, -3, false));
+	event(MouseClickData::Make(true, true, false, false));
+	delay(250);
+	event(MouseMoveData::Make(100, 200, true));
+	delay(70);
+	event(KbdData::Make(0x1E, false, true, false));
+	delay(1000);
+	return data;
+}
+
+//v2: the v3 layout with 12 byte events and DelayData events of their own, in blocks of 4
+static std::vector<char> MakeV2()
+{
+	std::vector<RecordEventV2> events;
+	auto add = [&events](int uuid, uint8_t flags, uint16_t key, int32_t x, int32_t y)
+	{
+		events.push_back({ (uint8_t)uuid, flags, key, x, y });
+	};
+	add(DelayData::uuid, 0, 0, 2000, 0);
+	add(KbdData::uuid, KbdData::DOWN | KbdData::SC, 0x1E, 0, 0);
+	add(DelayData::uuid, 0, 0, 500, 0);
+	add(MouseMoveData::uuid, 0, 0, 5, -3);
+	add(MouseClickData::uuid, MouseClickData::DOWN | MouseClickData::LEFT, 0, 0, 0);
+	add(DelayData::uuid, 0, 0, 250, 0);
+	add(MouseMoveData::uuid, MouseMoveData::ABSOLUTE, 0, 100, 200);
+	add(DelayData::uuid, 0, 0, 70, 0);
+	add(KbdData::uuid, KbdData::SC, 0x1E, 0, 0);
+	add(DelayData::uuid, 0, 0, 1000, 0);
+
+	constexpr uint32_t eventsPerBlock = 4;
+	const uint32_t blockCount = uint32_t((events.size() + eventsPerBlock - 1) / eventsPerBlock);
+
+	RecordHeader header {};
+	std::memcpy(header.magic, RecordHeader::MAGIC, sizeof(RecordHeader::MAGIC));
+	header.version = RecordHeader::VERSION_V2;
+	header.headerSize = sizeof(RecordHeader);
+	header.eventSize = sizeof(RecordEventV2);
+	header.eventsPerBlock = eventsPerBlock;
+	header.eventCount = events.size();
+	header.duration = 3820;
+	header.indexOffset = sizeof(RecordHeader) + events.size() * sizeof(RecordEventV2);
+	header.blockCount = blockCount;
+	header.nToggleKeys = (uint8_t)toggle.size();
+	std::copy(toggle.begin(), toggle.end(), header.toggleKeys);
+
+	std::vector<char> data;
+	Write(data, header);
+	for (const auto& it : events)
+		Write(data, it);
+	for (uint32_t i = 0; i < blockCount; ++i)
+	{
+		RecordBlock block {};
+		block.offset = sizeof(RecordHeader) + size_t(i) * eventsPerBlock * sizeof(RecordEventV2);
+		block.eventCount = std::min<uint32_t>(eventsPerBlock, uint32_t(events.size() - i * eventsPerBlock));
+		Write(data, block);
+	}
+	return data;
+}
+
+//Decodes a fixture, saves it as v3 and checks the v3 file decodes and maps to the same events
+//and encodes back to the same bytes
+static void CheckRoundTrip(const char* name, const std::vector<char>& fixture, int version)
+{
+	const std::string what = name;
+	InputHandler handler;
+	Check(handler.Decode(fixture.data(), fixture.size()), what + " decodes: " + handler.GetLoadError());
+	Check(handler.GetFormatVersion() == version, what + " format version");
+	Check(handler.GetToggleVKeys() == toggle, what + " toggle keys");
+	Check(Same(handler.GetEvents(), expected), what + " events");
+	Check(handler.GetDuration() == 3820, what + " duration");
+
+	std::vector<char> v3;
+	handler.Encode(v3);
+	Check(RecordHeader::Matches(v3.data(), v3.size()), what + " encodes v3");
+
+	InputHandler decoded;
+	Check(decoded.Decode(v3.data(), v3.size()), what + " v3 decodes: " + decoded.GetLoadError());
+	Check(decoded.GetFormatVersion() == RecordHeader::VERSION, what + " v3 format version");
+	Check(Same(decoded.GetEvents(), expected), what + " v3 events");
+
+	std::vector<char> again;
+	decoded.Encode(again);
+	Check(again == v3, what + " v3 encodes to the same bytes");
+
+	const std::string filename = (std::filesystem::temp_directory_path() / (what + ".test.dat")).string();
+	Check(decoded.Save(filename.c_str()), what + " saves");
+	InputHandler mapped;
+	Check(mapped.Map(filename.c_str()), what + " maps: " + mapped.GetLoadError());
+	Check(Same(mapped.GetEvents(), expected) && mapped.HasRecorded(), what + " mapped events");
+	mapped.Cleanup();
+	std::remove(filename.c_str());
+
+	//Toggle combos too long for the header are still written as v1
+	InputHandler longToggle(VKeyList(RecordHeader::MAX_TOGGLE_KEYS + 1, 'A'));
+	for (const auto& it : expected)
+	{
+		if (it.GetUUID() == DelayData::uuid)
+		{
+			longToggle.AddDelay(it.GetDelay());
+		}
+		else
+		{
+			longToggle.AddDelay(it.GetDelay());
+			longToggle.Add(WithDelay(it, 0));
+		}
+	}
+	std::vector<char> v1;
+	longToggle.Encode(v1);
+	InputHandler v1Decoded;
+	Check(v1Decoded.Decode(v1.data(), v1.size()) && (v1Decoded.GetFormatVersion() == 1), what + " v1 output decodes");
+	Check(Same(v1Decoded.GetEvents(), expected), what + " v1 output events");
+}
+
+//A batch cut short by an invalid event is still played up to it
+static void CheckInvalidEvent()
+{
+	Input invalid;
+	invalid.type = MAX_UUID + 1;
+	const std::vector<Input> events =
+	{
+		WithDelay(KbdData::Make(0x1E, true, true, false), 100),
+		MouseMoveData::Make(5, -3, false),
+		invalid,
+		WithDelay(KbdData::Make(0x1E, false, true, false), 50)
+	};
+
+	PlaybackPlan plan;
+	plan.Build({ events.data(), events.size() }, 1);
+	const auto& batches = plan.GetBatches();
+	Check(!plan.IsComplete(), "plan with an invalid event is incomplete");
+	Check((batches.size() == 1) && (batches[0].deadline == 100) && (batches[0].first == 0) && (batches[0].count == 2), "plan keeps the batch before an invalid event");
+	Check(plan.GetEventCount() == 2, "plan event count up to an invalid event");
+	Check(plan.GetDuration() == 100, "plan duration up to an invalid event");
+}
+
+static KbdEvent Key(VKey vKey, bool down)
+{
+	KbdEvent kbd;
+	kbd.vKey = vKey;
+	kbd.down = down;
+	return kbd;
+}
+
+static void CheckSequences()
+{
+	SequenceMatcher matcher;
+	matcher.Add({ VK::CONTROL, 'K' }, 0);
+	matcher.Add({ VK::CONTROL, 'K', SequenceMatcher::SEPARATOR, 'M' }, 1);
+	matcher.Add({ VK::F2, SequenceMatcher::SEPARATOR, VK::F2 }, 2);
+	matcher.Add({ VK::CONTROL, VK::SHIFT, 'K' }, 3);
+	matcher.Build();
+
+	Keys keys;
+	int64_t timestamp = 0;
+	auto press = [&](VKey vKey, bool down)
+	{
+		const KbdEvent kbd = Key(vKey, down);
+		keys.OnKey(kbd);
+		return matcher.OnKey(kbd, keys, timestamp += 1000000);
+	};
+
+	Check(press(VK::CONTROL, true) == SequenceMatcher::NONE, "CONTROL alone");
+	Check(press('K', true) == 0, "CONTROL+K");
+	press('K', false);
+	press(VK::CONTROL, false);
+	Check(press('M', true) == 1, "CONTROL+K then M");
+	press('M', false);
+
+	Check(press(VK::F2, true) == SequenceMatcher::NONE, "F2 once");
+	press(VK::F2, false);
+	Check(press(VK::F2, true) == 2, "F2 twice");
+	press(VK::F2, false);
+
+	press(VK::CONTROL, true);
+	press(VK::SHIFT, true);
+	Check(press('K', true) == 3, "CONTROL+SHIFT+K picks the combo with the most held keys");
+	press('K', false);
+	press(VK::SHIFT, false);
+	press(VK::CONTROL, false);
+
+	Check(press('K', true) == SequenceMatcher::NONE, "K without CONTROL");
+	press('K', false);
+
+	//Steps too far apart start over
+	press(VK::F2, true);
+	press(VK::F2, false);
+	timestamp += SequenceMatcher::DEFAULT_TIMEOUT;
+	Check(press(VK::F2, true) == SequenceMatcher::NONE, "F2 twice after the timeout");
+	press(VK::F2, false);
+}
+
+//Values come out in order, a full ring refuses and counts pushes, and the high-water mark only
+//counts what is actually queued
+static void CheckRing()
+{
+	SpscRing<int> ring(8);
+	int out[8] = {};
+	for (int i = 0; i < 4; ++i)
+		ring.Push(i);
+	Check((ring.PopBatch(out, 8) == 4) && (out[0] == 0) && (out[3] == 3), "ring pops in order");
+	Check(ring.Empty(), "ring empty after popping everything");
+
+	//The producer's cached tail still says 4 are queued
+	ring.Push(4);
+	ring.Push(5);
+	Check(ring.GetHighWaterMark() == 4, "ring high-water mark counts the actual tail");
+
+	bool pushed = true;
+	for (int i = 6; i < 12; ++i)
+		pushed = ring.Push(i) && pushed;
+	Check(pushed && (ring.GetOverflowCount() == 0) && (ring.GetHighWaterMark() == 8), "ring fills to capacity");
+	Check(!ring.Push(12) && !ring.Push(13) && (ring.GetOverflowCount() == 2), "full ring counts overflows");
+	Check((ring.PopBatch(out, 3) == 3) && (out[0] == 4) && (out[2] == 6), "ring pops a partial batch");
+	Check(ring.Push(12), "ring takes pushes again once popped");
+}
+
+//A pause holds the deadline back by as long as it lasted and an abort ends a pending wait.
+//Only lower bounds are checked on the times, a loaded machine may always be late.
+static void CheckScheduler()
+{
+	using namespace std::chrono;
+	Scheduler scheduler;
+
+	const auto begin = Scheduler::Clock::now();
+	scheduler.Start();
+	scheduler.AdvanceTo(milliseconds(20));
+	scheduler.Pause();
+	std::thread resume([&scheduler]()
+	{
+		std::this_thread::sleep_for(milliseconds(50));
+		scheduler.Resume();
+	});
+	Check(scheduler.Wait(), "scheduler wait resumes after a pause");
+	resume.join();
+	Check(Scheduler::Clock::now() - begin >= milliseconds(70), "scheduler holds the deadline back by the pause");
+
+	scheduler.Start();
+	scheduler.AdvanceTo(seconds(60));
+	std::thread abort([&scheduler]()
+	{
+		std::this_thread::sleep_for(milliseconds(20));
+		scheduler.Abort();
+	});
+	Check(!scheduler.Wait() && scheduler.IsAborted(), "scheduler abort ends a pending wait");
+	abort.join();
+	Check(!scheduler.Wait(), "scheduler stays aborted until reset");
+
+	scheduler.Reset();
+	scheduler.Start();
+	Check(scheduler.Wait() && !scheduler.IsAborted(), "scheduler waits again after a reset");
+	scheduler.Stop();
+}
+
+//A playing record refuses another Start, can be paused and aborted, and reports how it ended
+//once the player is idle again
+static void CheckPlayer()
+{
+	MemorySink sink;
+	Player player(sink);
+	std::atomic<int> result { -1 };
+	Event finished;
+	auto onFinished = [&result, &finished](bool completed)
+	{
+		result = completed;
+		finished.Set();
+	};
+
+	InputHandler tenSeconds;
+	tenSeconds.Add<KbdData>(0x1E, true, true, false);
+	tenSeconds.AddDelay(10000000);
+	tenSeconds.Add<KbdData>(0x1E, false, true, false);
+
+	Check(player.Start(tenSeconds, onFinished), "player starts");
+	Check(!player.Start(tenSeconds) && player.IsPlaying(), "player refuses a second start while playing");
+	player.Pause();
+	Check(player.IsPaused(), "player pauses");
+	player.Abort();
+	player.Wait();
+	finished.Wait();
+	Check((result == 0) && !player.IsPlaying() && !player.IsPaused(), "player reports an aborted record");
+
+	InputHandler oneMilli;
+	oneMilli.Add<KbdData>(0x1E, true, true, false);
+	oneMilli.AddDelay(1000);
+	oneMilli.Add<KbdData>(0x1E, false, true, false);
+
+	sink.Clear();
+	finished.Reset();
+	Check(player.Start(oneMilli, onFinished), "player starts again after an abort");
+	player.Wait();
+	finished.Wait();
+	Check((result == 1) && (sink.GetEntries().size() == 2), "player reports a completed record");
+}
+
+//Resampled moves follow the recorded path at most a period apart, and a move after a pause is
+//spread over the last period of it instead of the whole pause
+static void CheckResample()
+{
+	const std::vector<Input> events =
+	{
+		MouseMoveData::Make(10, 0, false),
+		WithDelay(MouseMoveData::Make(10, 0, false), 1000500)
+	};
+
+	PlaybackPlan plan;
+	plan.Build({ events.data(), events.size() }, 1, 1000);
+	const std::vector<Input> resampled =
+	{
+		MouseMoveData::Make(10, 0, false),
+		WithDelay(MouseMoveData::Make(5, 0, false), 1000000),
+		WithDelay(MouseMoveData::Make(5, 0, false), 500)
+	};
+	Check(Same(plan.GetEvents(), resampled), "resampled moves skip a pause");
+	Check(plan.GetDuration() == 1000500, "resampled duration");
+
+	//Sampling every microsecond of over an hour would take minutes
+	const std::vector<Input> longPause =
+	{
+		MouseMoveData::Make(10, 0, false),
+		WithDelay(MouseMoveData::Make(10, 0, false), 4000000000)
+	};
+	plan.Build({ longPause.data(), longPause.size() }, 2, 1000000);
+	Check(Same(plan.GetEvents(), longPause), "resampled moves skip a long pause");
+}
+
+//Seek finds events by their time, Trim keeps the events in a range and times them from its start
+static void CheckTimeline()
+{
+	const std::vector<char> fixture = MakeV2();
+	InputHandler handler;
+	handler.Decode(fixture.data(), fixture.size());
+	const Timeline& timeline = handler.GetTimeline();
+	Check((timeline.GetEventCount() == expected.size()) && (timeline.GetDuration() == 3820), "timeline event count and duration");
+	Check((timeline.GetTime(0) == 2000) && (timeline.GetTime(2) == 2500) && (timeline.GetTime(5) == 3820), "timeline event times");
+	Check((handler.Seek(0) == 0) && (handler.Seek(2000) == 0) && (handler.Seek(2001) == 1), "seek to the first event");
+	Check((handler.Seek(2500) == 1) && (handler.Seek(2600) == 3), "seek between events");
+	Check((handler.Seek(3820) == 5) && (handler.Seek(3821) == expected.size()), "seek to the end");
+
+	Check(!handler.Trim(2800, 2400), "trim refuses an empty range");
+	Check(handler.Trim(2400, 2800), "trim");
+	const std::vector<Input> trimmed =
+	{
+		WithDelay(MouseMoveData::Make(5, -3, false), 100),
+		WithDelay(MouseClickData::Make(true, true, false, false), 0),
+		WithDelay(MouseMoveData::Make(100, 200, true), 250),
+		DelayData::Make(50)
+	};
+	Check(Same(handler.GetEvents(), trimmed), "trimmed events");
+	Check((handler.GetDuration() == 400) && (handler.Seek(350) == 2), "trimmed timeline is rebuilt");
+}
+
+//Relative moves are merged until a merged move would span more than the quantum or cover more
+//than the pixel limit, and each merged move is recorded at the time of its last move
+static void CheckCoalescing()
+{
+	constexpr int64_t milli = 1000000;
+	InputHandler handler;
+	InputHandler::MotionCoalescing coalescing;
+	coalescing.enabled = true;
+	coalescing.quantumMicro = 8000;
+	handler.SetMotionCoalescing(coalescing);
+
+	handler.StartRecording(0);
+	handler.AddRelativeMove(1, 0, 1 * milli);
+	handler.AddRelativeMove(2, 0, 3 * milli);
+	handler.AddRelativeMove(3, 0, 8 * milli);
+	handler.AddRelativeMove(4, 0, 10 * milli);
+	handler.AddDelayUntil(20 * milli);
+	handler.Add<KbdData>(0x1E, true, true, false);
+	handler.StopRecording();
+
+	const std::vector<Input> merged =
+	{
+		WithDelay(MouseMoveData::Make(6, 0, false), 8000),
+		WithDelay(MouseMoveData::Make(4, 0, false), 2000),
+		WithDelay(KbdData::Make(0x1E, true, true, false), 10000)
+	};
+	Check(Same(handler.GetEvents(), merged), "moves merged within the quantum");
+	Check((handler.GetMotionStats().moves == 4) && (handler.GetMotionStats().recorded == 2), "coalescing stats");
+
+	coalescing.maxPixels = 5;
+	handler.SetMotionCoalescing(coalescing);
+	handler.StartRecording(0);
+	handler.AddRelativeMove(3, 0, 1 * milli);
+	handler.AddRelativeMove(3, 0, 2 * milli);
+	handler.AddRelativeMove(0, 4, 3 * milli);
+	handler.StopRecording();
+
+	const std::vector<Input> limited =
+	{
+		WithDelay(MouseMoveData::Make(3, 0, false), 1000),
+		WithDelay(MouseMoveData::Make(3, 4, false), 2000)
+	};
+	Check(Same(handler.GetEvents(), limited), "moves merged within the pixel limit");
+
+	handler.SetMotionCoalescing(InputHandler::MotionCoalescing());
+	handler.StartRecording(0);
+	handler.AddRelativeMove(1, 0, 1 * milli);
+	handler.AddRelativeMove(1, 0, 2 * milli);
+	handler.StopRecording();
+	Check((handler.GetEvents().size == 2) && (handler.GetMotionStats().recorded == 2), "moves kept as recorded without coalescing");
+}
+
+//Points within the tolerance of the segment between the kept points around them are dropped,
+//runs of relative moves are replaced by the kept ones at the same times
+static void CheckSimplify()
+{
+	using Point = PathSimplifier::Point;
+	PathSimplifier simplifier;
+	const Point corner[] = { { 0, 0 }, { 5, 1 }, { 10, 0 }, { 10, 10 } };
+	Check(simplifier.Simplify(corner, 4, 1.5) == std::vector<size_t>({ 0, 2, 3 }), "simplify keeps the corner");
+	Check(simplifier.Simplify(corner, 4, 0.5) == std::vector<size_t>({ 0, 1, 2, 3 }), "simplify keeps points past the tolerance");
+
+	//On the line through its neighbours but past the end of the segment between them
+	const Point overshoot[] = { { 0, 0 }, { 12, 0 }, { 10, 0 } };
+	Check(simplifier.Simplify(overshoot, 3, 1) == std::vector<size_t>({ 0, 1, 2 }), "simplify measures to the segment");
+
+	InputHandler handler;
+	handler.Add(WithDelay(MouseMoveData::Make(5, 1, false), 1000));
+	handler.Add(WithDelay(MouseMoveData::Make(5, -1, false), 1000));
+	handler.Add(WithDelay(MouseMoveData::Make(0, 10, false), 1000));
+	handler.Add(WithDelay(KbdData::Make(0x1E, true, true, false), 500));
+	Check(handler.SimplifyMotion(1.5), "simplify motion");
+
+	const std::vector<Input> simplified =
+	{
+		WithDelay(MouseMoveData::Make(10, 0, false), 2000),
+		WithDelay(MouseMoveData::Make(0, 10, false), 1000),
+		WithDelay(KbdData::Make(0x1E, true, true, false), 500)
+	};
+	Check(Same(handler.GetEvents(), simplified) && (handler.GetDuration() == 3500), "simplified events");
+	Check((handler.GetMotionStats().moves == 3) && (handler.GetMotionStats().recorded == 2), "simplify stats");
+}
+
+//The held keys usually match one combo exactly through the hash, otherwise the combos of the
+//trigger are scanned for the one with the most held keys
+static void CheckHotkeys()
+{
+	HotkeyIndex index;
+	index.Add({ VK::CONTROL, 'K' }, 0);
+	index.Add({ VK::CONTROL, VK::SHIFT, 'K' }, 1);
+	index.Add({ VK::MENU, 'K' }, 2);
+	index.Add({ 'K' }, 3);
+	index.Add({ VK::CONTROL, 'K' }, 4);
+	Check(index.GetCount() == 4, "hotkeys with the same keys are added once");
+
+	const KbdEvent down = Key('K', true);
+	Check(index.Find(down, { VK::CONTROL, 'K' }) == 0, "hotkey matched exactly");
+	Check(index.Find(down, { VK::CONTROL, VK::SHIFT, 'K' }) == 1, "hotkey with more held keys matched exactly");
+	Check(index.Find(down, { 'K' }) == 3, "hotkey without held keys matched exactly");
+	Check(index.Find(down, { VK::CONTROL, 'K', 'X' }) == 0, "keys held by no hotkey are ignored");
+	Check(index.Find(down, { VK::CONTROL, VK::MENU, 'K' }) == 0, "scan picks the first hotkey with the most held keys");
+	Check(index.Find(down, { VK::SHIFT, VK::MENU, 'K' }) == 2, "scan skips hotkeys not held");
+	Check(index.Find(Key('K', false), { VK::CONTROL }) == HotkeyIndex::NONE, "hotkeys trigger on key down only");
+	Check(index.Find(Key('M', true), { VK::CONTROL, 'M' }) == HotkeyIndex::NONE, "hotkey of another trigger");
+
+	index.Clear();
+	Check((index.GetCount() == 0) && (index.Find(down, { VK::CONTROL, 'K' }) == HotkeyIndex::NONE), "hotkeys cleared");
+}
+
+//A cataloged record is only listed from the catalog while its file keeps the size and write time
+//it was cataloged with, and the catalog drops the entries of files that are gone
+static void CheckCatalog()
+{
+	RecordCatalog catalog;
+	RecordCatalog::Entry entry;
+	entry.size = 100;
+	entry.mtime = 5;
+	entry.toggleVKeys = toggle;
+	entry.eventCount = expected.size();
+	entry.duration = 3820;
+	catalog.Set("Record.dat", entry);
+	Check(catalog.Find("Record.dat", 100, 5) != nullptr, "catalog entry found");
+	Check(!catalog.Find("Record.dat", 101, 5) && !catalog.Find("Record.dat", 100, 6) && !catalog.Find("Other.dat", 100, 5), "catalog entry invalidated by size, write time and name");
+
+	const std::filesystem::path dir = std::filesystem::temp_directory_path() / "MacroTests.catalog";
+	std::filesystem::remove_all(dir);
+	std::filesystem::create_directories(dir);
+	const std::string catalogFile = (dir / RecordCatalog::FILENAME).string();
+
+	RecordCatalog loaded;
+	Check(catalog.Save(catalogFile) && loaded.Load(catalogFile), "catalog saves and loads");
+	const RecordCatalog::Entry* found = loaded.Find("Record.dat", 100, 5);
+	Check(found && (found->toggleVKeys == toggle) && (found->eventCount == expected.size()) && (found->duration == 3820), "catalog entry loaded");
+
+	std::vector<char> truncated;
+	File::ReadFile(catalogFile, truncated);
+	truncated.pop_back();
+	File::WriteFile(catalogFile, truncated);
+	Check(!loaded.Load(catalogFile) && (loaded.GetCount() == 0), "truncated catalog loads as empty");
+	std::filesystem::remove(catalogFile);
+
+	const std::vector<char> fixture = MakeV2();
+	InputHandler handler;
+	handler.Decode(fixture.data(), fixture.size());
+	const std::string record = (dir / "Record.dat").string();
+	handler.Save(record.c_str());
+
+	MemorySink sink;
+	auto initialize = [&sink, &dir]()
+	{
+		RecordList records(sink);
+		records.Initialize(dir.string());
+		return records.GetLoadStats();
+	};
+	Check((initialize().cached == 0) && std::filesystem::exists(catalogFile), "records are cataloged");
+	Check(initialize().cached == 1, "unchanged record listed from the catalog");
+
+	handler.Trim(0, 2600);
+	handler.Save(record.c_str());
+	const RecordList::LoadStats changed = initialize();
+	Check((changed.cached == 0) && (changed.records == 1), "changed record read again");
+	Check(initialize().cached == 1, "changed record cataloged again");
+
+	std::filesystem::remove(record);
+	Check((initialize().records == 0) && loaded.Load(catalogFile) && (loaded.GetCount() == 0), "catalog drops removed records");
+	std::filesystem::remove_all(dir);
+}
+
+int main()
+{
+	CheckRoundTrip("v1", MakeV1(), 1);
+	CheckRoundTrip("v2", MakeV2(), RecordHeader::VERSION_V2);
+	CheckInvalidEvent();
+	CheckResample();
+	CheckTimeline();
+	CheckCoalescing();
+	CheckSimplify();
+	CheckSequences();
+	CheckHotkeys();
+	CheckCatalog();
+	CheckRing();
+	CheckScheduler();
+	CheckPlayer();
+
+	if (failures != 0)
+	{
+		std::cerr << failures << " checks failed\n";
+		return 1;
+	}
+	std::cout << "all checks passed\n";
+	return 0;
+}
\ No newline at end of file
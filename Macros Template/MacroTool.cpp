@@ -0,0 +1,588 @@
+#include "InputHandler.h"
+#include "RecordList.h"
+#include "MemorySink.h"
+#include "File.h"
+#include "HotkeyIndex.h"
+#include "SequenceMatcher.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+
+static const char* const typeNames[] = { "DelayMilli", "MouseClick", "MouseXClick", "MouseMove", "MouseScroll", "Kbd", "Delay" };
+
+static int Usage()
+{
+	std::cerr <<
+		"usage: MacroTool <command> [args]\n"
+		"  info <file>...    print the toggle keys and event counts of records\n"
+		"  play <file> [move rate hz] [from us] [to us]\n"
+		"                    play a record, or the part from..to, into a MemorySink and report the timing error\n"
+		"  coalesce <file> <out> [quantum us] [max pixels]\n"
+		"                    record a record again with its relative mouse moves merged\n"
+		"  trim <file> <out> <from us> <to us>\n"
+		"                    keep only the part of a record from..to\n"
+		"  simplify <file> <out> [tolerance px]\n"
+		"                    reduce the relative mouse moves of a record to a simplified path\n"
+		"  bench load <file> [iterations]\n"
+		"                    time reading and decoding a record\n"
+		"  bench save <file> [iterations]\n"
+		"                    time encoding and saving a record, to <file>.bench\n"
+		"  bench library <dir> [threads] [preload]\n"
+		"                    time listing a record directory and then loading each record\n"
+		"  bench hotkeys [count]\n"
+		"                    time matching key presses against count random toggle combos\n";
+	return 1;
+}
+
+//Maps v3 records like RecordList does and decodes anything else
+static bool Open(InputHandler& handler, const char* filename)
+{
+	return handler.Map(filename) || handler.Load(filename);
+}
+
+static int Info(int argc, char** argv)
+{
+	int res = 0;
+	for (int i = 0; i < argc; ++i)
+	{
+		InputHandler handler;
+		if (!Open(handler, argv[i]))
+		{
+			std::cerr << argv[i] << ": failed to load, " << handler.GetLoadError() << '\n';
+			res = 1;
+			continue;
+		}
+
+		//Mapped records are only validated as they are played
+		size_t counts[MAX_UUID + 1] {}, invalid = 0;
+		for (const auto& it : handler.GetEvents())
+		{
+			if (it.IsValid())
+				++counts[it.GetUUID()];
+			else
+				++invalid;
+		}
+
+		std::cout << argv[i] << ": v" << handler.GetFormatVersion() << ", toggle "
+			<< (handler.GetToggleVKeys().empty() ? "-" : handler.FormatVKeys()) << ", " << handler.GetEvents().size
+			<< (handler.IsMapped() ? " mapped" : "") << " events, " << handler.GetDuration() << "us\n";
+		for (int t = 1; t <= MAX_UUID; ++t)
+			std::cout << "  " << typeNames[t] << ' ' << counts[t] << '\n';
+		if (invalid != 0)
+		{
+			std::cout << "  Invalid " << invalid << '\n';
+			res = 1;
+		}
+	}
+	return res;
+}
+
+//Replays the events of a record into a new recording with their original timestamps, the
+//same calls MouseBIProc makes, so the coalescer sees what it would have seen live
+static int Coalesce(const char* filename, const char* out, uint32_t quantumMicro, uint32_t maxPixels)
+{
+	InputHandler handler;
+	if (!Open(handler, filename))
+	{
+		std::cerr << filename << ": failed to load, " << handler.GetLoadError() << '\n';
+		return 1;
+	}
+
+	InputHandler::MotionCoalescing coalescing;
+	coalescing.enabled = true;
+	coalescing.quantumMicro = quantumMicro;
+	coalescing.maxPixels = maxPixels;
+
+	InputHandler coalesced(handler.GetToggleVKeys());
+	coalesced.SetMotionCoalescing(coalescing);
+	coalesced.StartRecording(0);
+
+	int64_t timestamp = 0;
+	for (const auto& it : handler.GetEvents())
+	{
+		if (!it.IsValid())
+		{
+			std::cerr << filename << ": invalid event\n";
+			return 1;
+		}
+
+		timestamp += int64_t(it.GetDelay()) * 1000;
+		if (it.GetUUID() == DelayData::uuid)
+		{
+			continue;
+		}
+		else if ((it.GetUUID() == MouseMoveData::uuid) && !(it.flags & MouseMoveData::ABSOLUTE))
+		{
+			coalesced.AddRelativeMove(it.x, it.y, timestamp);
+		}
+		else
+		{
+			Input input = it;
+			input.delay = 0;
+			coalesced.AddDelayUntil(timestamp);
+			coalesced.Add(input);
+		}
+	}
+	coalesced.AddDelayUntil(timestamp);
+	coalesced.StopRecording();
+
+	if (!coalesced.Save(out))
+	{
+		std::cerr << out << ": failed to save\n";
+		return 1;
+	}
+
+	const auto& stats = coalesced.GetMotionStats();
+	const size_t before = handler.GetEvents().size, after = coalesced.GetEvents().size;
+	std::cout << filename << ": " << stats.moves << " relative moves -> " << stats.recorded << ", " << before << " events -> "
+		<< after << " (" << (after ? double(before) / after : 0.0) << "x fewer), " << handler.GetDuration() << "us -> "
+		<< coalesced.GetDuration() << "us\n";
+	return 0;
+}
+
+static int Trim(const char* filename, const char* out, uint64_t from, uint64_t to)
+{
+	InputHandler handler;
+	if (!Open(handler, filename))
+	{
+		std::cerr << filename << ": failed to load, " << handler.GetLoadError() << '\n';
+		return 1;
+	}
+
+	//Built apart so the cost of the index and of a single seek are reported separately
+	using namespace std::chrono;
+	auto start = steady_clock::now();
+	handler.GetTimeline();
+	const auto buildTime = duration_cast<nanoseconds>(steady_clock::now() - start);
+
+	start = steady_clock::now();
+	const size_t first = handler.Seek(from);
+	const auto seekTime = duration_cast<nanoseconds>(steady_clock::now() - start);
+
+	const size_t before = handler.GetEvents().size;
+	const uint64_t duration = handler.GetDuration();
+	start = steady_clock::now();
+	if (!handler.Trim(from, to) || !handler.Save(out))
+	{
+		std::cerr << out << ": failed to trim or save\n";
+		return 1;
+	}
+	const auto trimTime = duration_cast<microseconds>(steady_clock::now() - start);
+
+	std::cout << filename << ": " << before << " events -> " << handler.GetEvents().size << ", " << duration << "us -> "
+		<< handler.GetDuration() << "us, from event " << first << '\n';
+	std::cout << "  timeline built in " << buildTime.count() / 1000 << "us, seek " << seekTime.count() << "ns, trim and save "
+		<< trimTime.count() << "us\n";
+	return 0;
+}
+
+static int Simplify(const char* filename, const char* out, double tolerance)
+{
+	InputHandler handler;
+	if (!Open(handler, filename))
+	{
+		std::cerr << filename << ": failed to load, " << handler.GetLoadError() << '\n';
+		return 1;
+	}
+
+	const size_t before = handler.GetEvents().size;
+	const uint64_t duration = handler.GetDuration();
+	const auto start = std::chrono::steady_clock::now();
+	if (!handler.SimplifyMotion(tolerance))
+	{
+		std::cerr << filename << ": invalid event\n";
+		return 1;
+	}
+	const auto time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+	if (!handler.Save(out))
+	{
+		std::cerr << out << ": failed to save\n";
+		return 1;
+	}
+
+	const auto& stats = handler.GetMotionStats();
+	const size_t after = handler.GetEvents().size;
+	std::cout << filename << ": " << stats.moves << " relative moves -> " << stats.recorded << ", " << before << " events -> "
+		<< after << " (" << (after ? double(before) / after : 0.0) << "x fewer) in " << time.count() << "us, "
+		<< duration << "us -> " << handler.GetDuration() << "us\n";
+	return 0;
+}
+
+static int Play(const char* filename, uint32_t moveRate, uint64_t from, uint64_t to)
+{
+	using namespace std::chrono;
+
+	InputHandler handler;
+	if (!Open(handler, filename))
+	{
+		std::cerr << filename << ": failed to load, " << handler.GetLoadError() << '\n';
+		return 1;
+	}
+
+	//Built here so its cost is reported apart from playback, Simulate reuses it
+	MemorySink sink;
+	const auto planStart = steady_clock::now();
+	const PlaybackPlan& plan = handler.GetPlan(sink, moveRate);
+	const auto planTime = duration_cast<microseconds>(steady_clock::now() - planStart);
+
+	//Offset of every injected event from where playback starts, as resampled if it is
+	std::vector<microseconds> expected;
+	for (const auto& it : plan.GetBatches())
+	{
+		if ((it.deadline >= from) && (it.deadline < to))
+			expected.insert(expected.end(), it.count, microseconds(it.deadline - from));
+	}
+	const microseconds offset(int64_t(std::min(to, handler.GetDuration()) - std::min(from, handler.GetDuration())));
+
+	Scheduler scheduler;
+	const bool completed = handler.SimulateRange(sink, scheduler, from, to, moveRate);
+	const auto end = Scheduler::Clock::now();
+	const auto start = scheduler.GetStart();
+
+	const auto& entries = sink.GetEntries();
+	microseconds maxError{ 0 }, drift{ 0 };
+	for (size_t i = 0, size = std::min(entries.size(), expected.size()); i < size; ++i)
+	{
+		drift = duration_cast<microseconds>(entries[i].time - start) - expected[i];
+		maxError = std::max(maxError, drift < microseconds{ 0 } ? -drift : drift);
+	}
+
+	if (!completed)
+		std::cerr << filename << ": playback stopped at an invalid event\n";
+
+	std::cout << filename << ": " << entries.size() << " events in " << sink.GetBatchCount() << " batches, "
+		<< duration_cast<microseconds>(end - start).count()
+		<< "us (recorded " << offset.count() << "us), max event error " << maxError.count()
+		<< "us, final drift " << drift.count() << "us, max wake lateness "
+		<< duration_cast<microseconds>(scheduler.GetMaxLateness()).count() << "us\n";
+	std::cout << "  plan: " << plan.GetBatches().size() << " batches, " << plan.GetEventCount() << " of "
+		<< handler.GetEvents().size << " events injected, built in " << planTime.count() << "us\n";
+	return completed ? 0 : 1;
+}
+
+static double Seconds(std::chrono::steady_clock::duration d)
+{
+	return std::chrono::duration<double>(d).count();
+}
+
+static void PrintRate(const char* what, size_t bytes, size_t events, int iterations, std::chrono::steady_clock::duration elapsed)
+{
+	const double seconds = Seconds(elapsed) / iterations;
+	std::cout << "  " << what << ": " << seconds * 1000.0 << "ms, " << (bytes / seconds) / (1024.0 * 1024.0) << " MB/s, "
+		<< (events / seconds) / 1e6 << " M events/s\n";
+}
+
+static int BenchLoad(const char* filename, int iterations)
+{
+	using Clock = std::chrono::steady_clock;
+
+	std::vector<char> data;
+	if (!File::ReadFile(filename, data))
+	{
+		std::cerr << filename << ": can't read file\n";
+		return 1;
+	}
+
+	InputHandler handler;
+	auto start = Clock::now();
+	for (int i = 0; i < iterations; ++i)
+	{
+		if (!handler.Decode(data.data(), data.size()))
+		{
+			std::cerr << filename << ": " << handler.GetLoadError() << '\n';
+			return 1;
+		}
+	}
+	const auto decodeTime = Clock::now() - start;
+
+	start = Clock::now();
+	for (int i = 0; i < iterations; ++i)
+		handler.Load(filename);
+	const auto loadTime = Clock::now() - start;
+
+	//Only the header and block index are read when mapping, so this doesn't scale with the events
+	start = Clock::now();
+	bool mapped = true;
+	for (int i = 0; (i < iterations) && mapped; ++i)
+		mapped = handler.Map(filename);
+	const auto mapTime = Clock::now() - start;
+	if (!mapped)
+		handler.Load(filename);
+
+	const size_t events = handler.GetEvents().size;
+	std::cout << filename << ": " << data.size() << " bytes, " << events << " events, " << iterations << " iterations\n";
+	PrintRate("decode", data.size(), events, iterations, decodeTime);
+	PrintRate("load", data.size(), events, iterations, loadTime);
+	if (mapped)
+		PrintRate("map", data.size(), events, iterations, mapTime);
+	return 0;
+}
+
+static int BenchSave(const char* filename, int iterations)
+{
+	using Clock = std::chrono::steady_clock;
+
+	InputHandler handler;
+	if (!handler.Load(filename))
+	{
+		std::cerr << filename << ": failed to load, " << handler.GetLoadError() << '\n';
+		return 1;
+	}
+
+	std::vector<char> data;
+	auto start = Clock::now();
+	for (int i = 0; i < iterations; ++i)
+		handler.Encode(data);
+	const auto encodeTime = Clock::now() - start;
+
+	const std::string outFilename = std::string(filename) + ".bench";
+	start = Clock::now();
+	for (int i = 0; i < iterations; ++i)
+	{
+		if (!handler.Save(outFilename.c_str()))
+		{
+			std::cerr << outFilename << ": failed to save\n";
+			return 1;
+		}
+	}
+	const auto saveTime = Clock::now() - start;
+	std::remove(outFilename.c_str());
+
+	const size_t events = handler.GetEvents().size;
+	std::cout << filename << ": " << data.size() << " bytes, " << events << " events, " << iterations << " iterations\n";
+	PrintRate("encode", data.size(), events, iterations, encodeTime);
+	PrintRate("save", data.size(), events, iterations, saveTime);
+	return 0;
+}
+
+static int BenchLibrary(const char* dir, unsigned threads, bool preload)
+{
+	MemorySink sink;
+	RecordList recordList(sink);
+	recordList.Initialize(dir, preload, threads);
+
+	const RecordList::LoadStats& stats = recordList.GetLoadStats();
+	std::cout << dir << ": " << stats.records << " records " << (preload ? "loaded" : "listed") << " in "
+		<< stats.initializeMicro / 1000.0 << "ms on " << (threads ? std::to_string(threads) : "all") << " threads\n";
+	std::cout << "  from catalog: " << stats.cached << ", read: " << stats.records - stats.cached << '\n';
+
+	const RecordList::LoadReport* slowest = nullptr;
+	for (const auto& it : recordList.GetLoadReports())
+	{
+		if (!it.error.empty())
+			std::cout << "  " << it.filename << ": " << it.error << '\n';
+		if (!slowest || (it.micro > slowest->micro))
+			slowest = &it;
+	}
+	if (slowest)
+		std::cout << "  slowest file: " << slowest->filename << ' ' << slowest->micro / 1000.0 << "ms\n";
+
+	size_t failed = 0;
+	uint64_t maxLoad = 0;
+	for (int i = 0, size = (int)recordList.GetRecordCount(); i < size; ++i)
+	{
+		if (!recordList.LoadRecord(i))
+			++failed;
+		maxLoad = std::max(maxLoad, stats.lastLoadMicro);
+	}
+
+	std::cout << "  deferred loads: " << stats.loaded << " in " << stats.loadMicro / 1000.0 << "ms, max "
+		<< maxLoad / 1000.0 << "ms, " << failed << " failed\n";
+	return 0;
+}
+
+//Feeds a SequenceMatcher the key events of its own triggers, every other one two steps long
+static void BenchSequences(const std::vector<VKeyList>& combos, size_t nTriggers, std::mt19937& rng)
+{
+	std::vector<VKeyList> triggers;
+	SequenceMatcher matcher;
+	for (size_t i = 0; i < nTriggers; ++i)
+	{
+		VKeyList vKeys = combos[rng() % combos.size()];
+		if (i % 2)
+		{
+			const VKeyList& next = combos[rng() % combos.size()];
+			vKeys.push_back(SequenceMatcher::SEPARATOR);
+			vKeys.insert(vKeys.end(), next.begin(), next.end());
+		}
+		matcher.Add(vKeys, (int)i);
+		triggers.push_back(std::move(vKeys));
+	}
+	matcher.Build();
+
+	//Every key of a step goes down in order and comes back up
+	std::vector<KbdEvent> events;
+	size_t nTyped = 0;
+	while (events.size() < 1000000)
+	{
+		const VKeyList& vKeys = triggers[rng() % triggers.size()];
+		for (auto begin = vKeys.begin(); begin != vKeys.end();)
+		{
+			const auto end = std::find(begin, vKeys.end(), SequenceMatcher::SEPARATOR);
+			for (bool down : { true, false })
+			{
+				for (auto it = begin; it != end; ++it)
+				{
+					KbdEvent kbd;
+					kbd.vKey = *it;
+					kbd.down = down;
+					events.push_back(kbd);
+				}
+			}
+			begin = (end == vKeys.end()) ? end : end + 1;
+		}
+		++nTyped;
+	}
+
+	Keys keys;
+	size_t matched = 0;
+	int64_t timestamp = 0;
+	const auto start = std::chrono::steady_clock::now();
+	for (const auto& it : events)
+	{
+		keys.OnKey(it);
+		matched += matcher.OnKey(it, keys, timestamp += 10000000) != SequenceMatcher::NONE;
+	}
+	const double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << "  sequences: " << matcher.GetCount() << " triggers, " << matcher.GetStateCount() << " states, "
+		<< time * 1e9 / events.size() << "ns per key event, " << matched << " matches for " << nTyped << " typed\n";
+}
+
+static int BenchHotkeys(size_t count)
+{
+	//Combos of 1 to 3 held keys out of 40 and a trigger out of 60, like a large library would use
+	std::mt19937 rng(1);
+	auto pick = [&rng](VKey first, int n)
+	{
+		return VKey(first + rng() % n);
+	};
+
+	std::set<VKeyList> unique;
+	while (unique.size() < count)
+	{
+		std::set<VKey> held;
+		for (size_t nHeld = 1 + rng() % 3; held.size() < nHeld;)
+			held.insert(pick(0x30, 40));
+
+		VKeyList vKeys(held.begin(), held.end());
+		vKeys.push_back(pick(0x70, 24));
+		if (rng() % 2)
+			vKeys.back() = pick('A', 26) + 10 * (rng() % 2);
+		unique.insert(vKeys);
+	}
+	const std::vector<VKeyList> combos(unique.begin(), unique.end());
+
+	const auto buildStart = std::chrono::steady_clock::now();
+	HotkeyIndex index;
+	for (size_t i = 0; i < combos.size(); ++i)
+		index.Add(combos[i], (int)i);
+	const double buildTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - buildStart).count();
+
+	//Each press completes a random combo
+	constexpr size_t nPresses = 4096;
+	std::vector<std::pair<KbdEvent, KeyMask>> presses(nPresses);
+	for (auto& it : presses)
+	{
+		const VKeyList& vKeys = combos[rng() % combos.size()];
+		it.first.vKey = vKeys.back();
+		it.first.down = true;
+		for (const VKey vKey : vKeys)
+			it.second.Set(vKey, true);
+	}
+
+	//What SelectRecord did before, one combo at a time, with the OS calls replaced by the same key state
+	auto scan = [&combos](const KbdEvent& kbd, const KeyMask& held)
+	{
+		for (size_t i = 0; i < combos.size(); ++i)
+		{
+			const VKeyList& vKeys = combos[i];
+			if (vKeys.back() != kbd.vKey)
+				continue;
+			if (std::all_of(vKeys.begin(), vKeys.end() - 1, [&held](VKey vKey) { return held.Test(vKey); }))
+				return (int)i;
+		}
+		return HotkeyIndex::NONE;
+	};
+
+	size_t indexFound = 0, scanFound = 0;
+	const size_t rounds = std::max<size_t>(1, 1000000 / nPresses);
+	const auto indexStart = std::chrono::steady_clock::now();
+	for (size_t r = 0; r < rounds; ++r)
+		for (const auto& it : presses)
+			indexFound += index.Find(it.first, it.second) != HotkeyIndex::NONE;
+	const double indexTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - indexStart).count();
+
+	const size_t scanRounds = std::max<size_t>(1, rounds * 100 / combos.size());
+	const auto scanStart = std::chrono::steady_clock::now();
+	for (size_t r = 0; r < scanRounds; ++r)
+		for (const auto& it : presses)
+			scanFound += scan(it.first, it.second) != HotkeyIndex::NONE;
+	const double scanTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - scanStart).count();
+
+	const size_t indexLookups = rounds * nPresses, scanLookups = scanRounds * nPresses;
+	std::cout << index.GetCount() << " hotkeys indexed in " << buildTime * 1000.0 << "ms\n";
+	std::cout << "  index: " << indexTime * 1e9 / indexLookups << "ns per key press, " << indexFound << '/' << indexLookups << " matched\n";
+	std::cout << "  scan:  " << scanTime * 1e9 / scanLookups << "ns per key press, " << scanFound << '/' << scanLookups << " matched\n";
+
+	BenchSequences(combos, std::min<size_t>(10, combos.size()), rng);
+	BenchSequences(combos, combos.size(), rng);
+	return (indexFound == indexLookups) ? 0 : 1;
+}
+
+static int Bench(int argc, char** argv)
+{
+	const std::string what = argv[0];
+	const int iterations = (argc > 2) ? std::max(1, std::atoi(argv[2])) : 10;
+	if ((what == "load") && (argc >= 2))
+		return BenchLoad(argv[1], iterations);
+	if ((what == "save") && (argc >= 2))
+		return BenchSave(argv[1], iterations);
+	if (what == "hotkeys")
+		return BenchHotkeys((argc > 1) ? (size_t)std::max(1, std::atoi(argv[1])) : 10000);
+	if ((what == "library") && (argc >= 2))
+	{
+		const unsigned threads = (argc > 2) ? (unsigned)std::max(0, std::atoi(argv[2])) : 0;
+		const bool preload = (argc > 3) && (std::string(argv[3]) == "preload");
+		return BenchLibrary(argv[1], threads, preload);
+	}
+
+	return Usage();
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+		return Usage();
+
+	const std::string command = argv[1];
+	if ((command == "info") && (argc > 2))
+		return Info(argc - 2, argv + 2);
+	if ((command == "play") && (argc >= 3) && (argc <= 6))
+	{
+		const uint32_t moveRate = (argc > 3) ? (uint32_t)std::max(0, std::atoi(argv[3])) : 0;
+		const uint64_t from = (argc > 4) ? std::strtoull(argv[4], nullptr, 10) : 0;
+		const uint64_t to = (argc > 5) ? std::strtoull(argv[5], nullptr, 10) : UINT64_MAX;
+		return Play(argv[2], moveRate, from, to);
+	}
+	if ((command == "trim") && (argc == 6))
+		return Trim(argv[2], argv[3], std::strtoull(argv[4], nullptr, 10), std::strtoull(argv[5], nullptr, 10));
+	if ((command == "coalesce") && (argc >= 4))
+	{
+		const uint32_t quantumMicro = (argc > 4) ? (uint32_t)std::max(0, std::atoi(argv[4])) : InputHandler::MotionCoalescing().quantumMicro;
+		const uint32_t maxPixels = (argc > 5) ? (uint32_t)std::max(0, std::atoi(argv[5])) : 0;
+		return Coalesce(argv[2], argv[3], quantumMicro, maxPixels);
+	}
+	if ((command == "simplify") && (argc >= 4))
+		return Simplify(argv[2], argv[3], (argc > 4) ? std::max(0.0, std::atof(argv[4])) : 1.0);
+	if ((command == "bench") && (argc > 2))
+		return Bench(argc - 2, argv + 2);
+
+	return Usage();
+}
@@ -0,0 +1,126 @@
+#include "MappedFile.h"
+#include <utility>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(MappedFile&& mf) noexcept
+	:
+	data(std::exchange(mf.data, nullptr)),
+	size(std::exchange(mf.size, 0))
+{}
+
+MappedFile& MappedFile::operator=(MappedFile&& mf) noexcept
+{
+	if (this != &mf)
+	{
+		Close();
+		data = std::exchange(mf.data, nullptr);
+		size = std::exchange(mf.size, 0);
+	}
+	return *this;
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+#ifdef _WIN32
+bool MappedFile::Open(const std::string& filename)
+{
+	Close();
+
+	//Without share delete, callers close a mapped record before deleting or rewriting its file
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || (fileSize.QuadPart == 0))
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	//The view keeps the mapping and the file open on its own
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (!mapping)
+		return false;
+
+	const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (!view)
+		return false;
+
+	data = (const char*)view;
+	size = (size_t)fileSize.QuadPart;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (data)
+		UnmapViewOfFile(data);
+
+	data = nullptr;
+	size = 0;
+}
+#else
+bool MappedFile::Open(const std::string& filename)
+{
+	Close();
+
+	const int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+	if ((fstat(fd, &st) != 0) || (st.st_size <= 0))
+	{
+		close(fd);
+		return false;
+	}
+
+	void* view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (view == MAP_FAILED)
+		return false;
+
+	//Playback reads front to back
+	posix_madvise(view, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+
+	data = (const char*)view;
+	size = (size_t)st.st_size;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (data)
+		munmap((void*)data, size);
+
+	data = nullptr;
+	size = 0;
+}
+#endif
+
+bool MappedFile::IsOpen() const
+{
+	return data != nullptr;
+}
+const char* MappedFile::GetData() const
+{
+	return data;
+}
+size_t MappedFile::GetSize() const
+{
+	return size;
+}
\ No newline at end of file
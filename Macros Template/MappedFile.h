@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+//Read only view of a whole file mapped into memory. Pages are only read from disk when they
+//are first touched, so an open but unused mapping costs address space rather than memory.
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile(MappedFile&& mf) noexcept;
+	MappedFile& operator=(MappedFile&& mf) noexcept;
+	~MappedFile();
+
+	//Fails for empty files, which can't be mapped
+	bool Open(const std::string& filename);
+	void Close();
+
+	bool IsOpen() const;
+	const char* GetData() const;
+	size_t GetSize() const;
+private:
+	const char* data = nullptr;
+	size_t size = 0;
+};
\ No newline at end of file
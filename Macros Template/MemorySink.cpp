@@ -0,0 +1,42 @@
+#include "MemorySink.h"
+
+bool MemorySink::SendKbd(uint16_t key, bool down, bool sc, bool E0)
+{
+	return Push(KbdData::Make(key, down, sc, E0));
+}
+bool MemorySink::SendClick(bool down, bool left, bool right, bool middle)
+{
+	return Push(MouseClickData::Make(down, left, right, middle));
+}
+bool MemorySink::SendXClick(bool down, bool x1, bool x2)
+{
+	return Push(MouseXClickData::Make(down, x1, x2));
+}
+bool MemorySink::SendMousePosition(int x, int y, bool absolute)
+{
+	return Push(MouseMoveData::Make(x, y, absolute));
+}
+bool MemorySink::SendMouseScroll(int nClicks)
+{
+	return Push(MouseScrollData::Make(nClicks));
+}
+
+bool MemorySink::SendBatch(const Input* inputs, size_t count)
+{
+	++batches;
+	return InputSink::SendBatch(inputs, count);
+}
+
+const std::vector<MemorySink::Entry>& MemorySink::GetEntries() const
+{
+	return entries;
+}
+size_t MemorySink::GetBatchCount() const
+{
+	return batches;
+}
+void MemorySink::Clear()
+{
+	entries.clear();
+	batches = 0;
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+#include <chrono>
+#include <vector>
+#include "InputSink.h"
+#include "InputData.h"
+
+//Records every injected event with the time it was sent, for headless playback
+class MemorySink : public InputSink
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	struct Entry
+	{
+		Clock::time_point time;
+		Input input;
+	};
+
+	MemorySink() = default;
+
+	bool SendKbd(uint16_t key, bool down, bool sc, bool E0) override;
+	bool SendClick(bool down, bool left, bool right, bool middle) override;
+	bool SendXClick(bool down, bool x1, bool x2) override;
+	bool SendMousePosition(int x, int y, bool absolute) override;
+	bool SendMouseScroll(int nClicks) override;
+	bool SendBatch(const Input* inputs, size_t count) override;
+
+	const std::vector<Entry>& GetEntries() const;
+	size_t GetBatchCount() const;
+	void Clear();
+private:
+	bool Push(const Input& input)
+	{
+		entries.push_back({ Clock::now(), input });
+		return true;
+	}
+
+	std::vector<Entry> entries;
+	size_t batches = 0;
+};
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+//Calls fn(i) for every i in [0, count) on up to threadCount threads, 0 uses one per core.
+//The calling thread works too. Indices are handed out one at a time so uneven jobs, like
+//files of very different sizes, still keep every thread busy.
+template<typename Fn>
+void ParallelFor(size_t count, Fn&& fn, unsigned threadCount = 0)
+{
+	if (threadCount == 0)
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	threadCount = (unsigned)std::min<size_t>(threadCount, count);
+
+	std::atomic<size_t> next { 0 };
+	auto worker = [&]()
+	{
+		for (size_t i = next++; i < count; i = next++)
+			fn(i);
+	};
+
+	std::vector<std::thread> threads;
+	for (unsigned i = 1; i < threadCount; ++i)
+		threads.emplace_back(worker);
+
+	worker();
+
+	for (auto& it : threads)
+		it.join();
+}
\ No newline at end of file
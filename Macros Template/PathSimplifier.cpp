@@ -0,0 +1,72 @@
+#include "PathSimplifier.h"
+
+//Squared distance from p to the segment ab, not the line through it, so a path that doubles
+//back on itself keeps the point where it turns
+static double DistanceSq(const PathSimplifier::Point& p, const PathSimplifier::Point& a, const PathSimplifier::Point& b)
+{
+	const double dx = double(b.x - a.x), dy = double(b.y - a.y);
+	const double px = double(p.x - a.x), py = double(p.y - a.y);
+	const double lengthSq = dx * dx + dy * dy;
+	const double t = px * dx + py * dy;
+	if ((lengthSq == 0.0) || (t <= 0.0))
+		return px * px + py * py;
+	if (t >= lengthSq)
+	{
+		const double qx = double(p.x - b.x), qy = double(p.y - b.y);
+		return qx * qx + qy * qy;
+	}
+
+	const double cross = px * dy - py * dx;
+	return cross * cross / lengthSq;
+}
+
+const std::vector<size_t>& PathSimplifier::Simplify(const Point* path, size_t size, double tolerance)
+{
+	kept.clear();
+	if (size <= 2)
+	{
+		for (size_t i = 0; i < size; ++i)
+			kept.push_back(i);
+		return kept;
+	}
+
+	const double toleranceSq = tolerance * tolerance;
+	keep.assign(size, 0);
+	keep.front() = keep.back() = 1;
+
+	stack.clear();
+	stack.emplace_back(0, size - 1);
+	while (!stack.empty())
+	{
+		const auto [first, last] = stack.back();
+		stack.pop_back();
+
+		double maxDistance = -1.0;
+		size_t farthest = first;
+		for (size_t i = first + 1; i < last; ++i)
+		{
+			const double distance = DistanceSq(path[i], path[first], path[last]);
+			if (distance > maxDistance)
+			{
+				maxDistance = distance;
+				farthest = i;
+			}
+		}
+
+		if (maxDistance <= toleranceSq)
+			continue;
+
+		keep[farthest] = 1;
+		if (farthest - first > 1)
+			stack.emplace_back(first, farthest);
+		if (last - farthest > 1)
+			stack.emplace_back(farthest, last);
+	}
+
+	for (size_t i = 0; i < size; ++i)
+	{
+		if (keep[i])
+			kept.push_back(i);
+	}
+	return kept;
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+//Ramer-Douglas-Peucker simplification of a mouse path. Runs without recursion on an explicit
+//stack and keeps its buffers between calls, so a whole library can be simplified with one.
+class PathSimplifier
+{
+public:
+	struct Point
+	{
+		int64_t x = 0, y = 0;
+	};
+
+	//Returns the indices of the points kept in increasing order, the first and last point always
+	//among them. Every dropped point lies within tolerance pixels of the segment between the kept
+	//points around it.
+	const std::vector<size_t>& Simplify(const Point* path, size_t size, double tolerance);
+private:
+	std::vector<std::pair<size_t, size_t>> stack;
+	std::vector<char> keep;
+	std::vector<size_t> kept;
+};
\ No newline at end of file
@@ -0,0 +1,259 @@
+#include "PlaybackPlan.h"
+#include "Scheduler.h"
+#include <algorithm>
+#include <cmath>
+
+struct MoveSample
+{
+	uint64_t time;	//Microseconds from the start of the record
+	int64_t x, y;	//Position after the move, relative ones summed from the start of their run
+};
+
+//Replaces every run of mouse moves of one kind, relative or absolute, with moves at most a period
+//apart taken from the path through the recorded ones. A recorded move is spread over the time
+//since the previous one, but no more than a period, so a move after a pause isn't smeared over
+//the pause. Positions are rounded from the exact path, so the sub-pixel error carries over to
+//the next move instead of adding up, and each run ends exactly where it was recorded to.
+static void Resample(InputSpan events, uint32_t moveRate, std::vector<Input>& out)
+{
+	const uint64_t period = std::max<uint64_t>(1, 1000000 / moveRate);
+	std::vector<MoveSample> run;
+	bool absolute = false;
+	uint64_t time = 0, written = 0;
+
+	auto addUntil = [&out, &written](uint64_t until)
+	{
+		Input::AppendDelay(out, until - written);
+		written = until;
+	};
+
+	auto addRun = [&]()
+	{
+		if (run.empty())
+			return;
+
+		//Where the cursor was last moved to, relative runs start from wherever it is
+		int64_t x = 0, y = 0;
+		bool first = absolute;
+		size_t next = 0;
+		for (uint64_t t = run.front().time;; t += period)
+		{
+			const bool last = t >= run.back().time;
+			if (last)
+				t = run.back().time;
+
+			while ((next < run.size()) && (run[next].time <= t))
+				++next;
+
+			const MoveSample& from = run[next - 1];
+			double posX = double(from.x), posY = double(from.y);
+			if (next < run.size())
+			{
+				const MoveSample& to = run[next];
+				const uint64_t begin = std::max(from.time, (to.time > period) ? to.time - period : 0);
+				if (t > begin)
+				{
+					const double f = double(t - begin) / double(to.time - begin);
+					posX += double(to.x - from.x) * f;
+					posY += double(to.y - from.y) * f;
+				}
+			}
+
+			const int64_t targetX = std::llround(posX), targetY = std::llround(posY);
+			if (first || (targetX != x) || (targetY != y))
+			{
+				addUntil(t);
+				if (absolute)
+				{
+					Input::Append(out, MouseMoveData::Make((int)targetX, (int)targetY, true));
+				}
+				else
+				{
+					for (int64_t dx = targetX - x, dy = targetY - y; (dx != 0) || (dy != 0);)
+					{
+						const int32_t stepX = (int32_t)std::clamp<int64_t>(dx, INT32_MIN, INT32_MAX);
+						const int32_t stepY = (int32_t)std::clamp<int64_t>(dy, INT32_MIN, INT32_MAX);
+						Input::Append(out, MouseMoveData::Make(stepX, stepY, false));
+						dx -= stepX;
+						dy -= stepY;
+					}
+				}
+				x = targetX;
+				y = targetY;
+				first = false;
+			}
+
+			if (last)
+				break;
+
+			//The path doesn't move until the next move's span begins, so the periods of a pause
+			//are skipped instead of sampled, staying on the same grid
+			const uint64_t begin = std::max(run[next - 1].time, (run[next].time > period) ? run[next].time - period : 0);
+			if (begin > t + period)
+				t += (begin - t) / period * period;
+		}
+		run.clear();
+	};
+
+	for (size_t i = 0; i < events.size; ++i)
+	{
+		const Input& it = events[i];
+		if (!it.IsValid())
+		{
+			//Kept as is for Build to stop at
+			addRun();
+			addUntil(time);
+			out.push_back(it);
+			out.back().delay = 0;
+			out.insert(out.end(), events.begin() + i + 1, events.end());
+			return;
+		}
+
+		time += it.GetDelay();
+		if (it.GetUUID() == DelayData::uuid)
+		{
+			continue;
+		}
+		else if (it.GetUUID() == MouseMoveData::uuid)
+		{
+			const bool isAbsolute = (it.flags & MouseMoveData::ABSOLUTE) != 0;
+			if (isAbsolute != absolute)
+				addRun();
+			absolute = isAbsolute;
+
+			if (absolute || run.empty())
+				run.push_back({ time, it.x, it.y });
+			else
+				run.push_back({ time, run.back().x + it.x, run.back().y + it.y });
+		}
+		else
+		{
+			addRun();
+			addUntil(time);
+			Input input = it;
+			input.delay = 0;
+			Input::Append(out, input);
+		}
+	}
+	addRun();
+	addUntil(time);
+}
+
+void PlaybackPlan::Build(InputSpan events, uint64_t revision, uint32_t moveRate)
+{
+	this->revision = revision;
+	this->moveRate = moveRate;
+	resampled.clear();
+	if (moveRate != 0)
+	{
+		Resample(events, moveRate, resampled);
+		events = { resampled.data(), resampled.size() };
+	}
+	this->events = events;
+	batches.clear();
+	eventCount = 0;
+	duration = 0;
+	complete = true;
+	compiled.reset();
+	compiledFor = typeid(void);
+
+	uint64_t deadline = 0;
+	for (size_t i = 0; i < events.size;)
+	{
+		//A batch is the events without a delay after the one starting it, DelayData ends one
+		//without being part of any, so batches hold nothing but injected events
+		deadline += events[i].GetDelay();
+		if (!events[i].IsValid())
+		{
+			complete = false;
+			return;
+		}
+		if (events[i].GetUUID() == DelayData::uuid)
+		{
+			++i;
+			continue;
+		}
+
+		//An invalid event ends the batch too, the events before it are still played
+		size_t end = i + 1;
+		while ((end < events.size) && events[end].IsValid() && (events[end].GetDelay() == 0) && (events[end].GetUUID() != DelayData::uuid))
+			++end;
+
+		batches.push_back({ deadline, i, eventCount, end - i });
+		eventCount += end - i;
+		duration = deadline;
+		i = end;
+	}
+	duration = deadline;
+}
+
+bool PlaybackPlan::IsBuilt(uint64_t revision, uint32_t moveRate) const
+{
+	return (this->revision == revision) && (this->moveRate == moveRate);
+}
+
+void PlaybackPlan::Compile(const InputSink& sink)
+{
+	if (compiledFor == typeid(sink))
+		return;
+
+	compiled = sink.Compile(*this);
+	compiledFor = typeid(sink);
+}
+
+bool PlaybackPlan::Play(InputSink& sink, Scheduler& scheduler, uint64_t from, uint64_t to) const
+{
+	const InputSink::Compiled* native = (compiledFor == typeid(sink)) ? compiled.get() : nullptr;
+	auto byDeadline = [](const Batch& batch, uint64_t deadline)
+	{
+		return batch.deadline < deadline;
+	};
+	const auto first = std::lower_bound(batches.begin(), batches.end(), from, byDeadline);
+	const auto last = std::lower_bound(first, batches.end(), to, byDeadline);
+
+	scheduler.Start();
+	for (auto it = first; it != last; ++it)
+	{
+		scheduler.AdvanceTo(std::chrono::microseconds(it->deadline - from));
+		if (!scheduler.Wait())
+			return false;
+
+		if (native)
+			sink.SendCompiled(*native, it->compiled, it->count);
+		else
+			sink.SendBatch(events.data + it->first, it->count);
+	}
+	if ((last == batches.end()) && !complete)
+		return false;
+
+	//The wait after the last event is part of the record too, so whatever is played next starts on time
+	const uint64_t end = std::min(duration, to);
+	if (end > from)
+	{
+		scheduler.AdvanceTo(std::chrono::microseconds(end - from));
+		if (!scheduler.Wait())
+			return false;
+	}
+	return true;
+}
+
+InputSpan PlaybackPlan::GetEvents() const
+{
+	return events;
+}
+const std::vector<PlaybackPlan::Batch>& PlaybackPlan::GetBatches() const
+{
+	return batches;
+}
+size_t PlaybackPlan::GetEventCount() const
+{
+	return eventCount;
+}
+uint64_t PlaybackPlan::GetDuration() const
+{
+	return duration;
+}
+bool PlaybackPlan::IsComplete() const
+{
+	return complete;
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <typeindex>
+#include <vector>
+#include "InputData.h"
+#include "InputSink.h"
+
+class Scheduler;
+
+//A record compiled for playback: every run of events between delays as one batch with its
+//deadline from the start of the record, and the events converted ahead of time into what the
+//sink injects. Built once per change of the record, so replaying it only waits and submits.
+class PlaybackPlan
+{
+public:
+	struct Batch
+	{
+		uint64_t deadline;	//Microseconds from the start of playback
+		size_t first;		//Index of the batch's first event in the record
+		size_t compiled;	//Index of its first event in the sink's compiled form
+		size_t count;
+	};
+
+	//events must stay valid while the plan is used, the plan ends before the first invalid event.
+	//A moveRate in Hz replays mouse moves resampled to at most that rate, 0 as recorded.
+	void Build(InputSpan events, uint64_t revision, uint32_t moveRate = 0);
+	bool IsBuilt(uint64_t revision, uint32_t moveRate = 0) const;
+	//Converts the events for the sink, kept until the plan is rebuilt or compiled for a sink of another type
+	void Compile(const InputSink& sink);
+	//Plays the batches due in [from, to), in microseconds, timed from from, and then waits until
+	//to or the end of the record. The first batch is found by binary search on the deadlines.
+	//Returns false if aborted or the part played ends at an invalid event.
+	bool Play(InputSink& sink, Scheduler& scheduler, uint64_t from = 0, uint64_t to = UINT64_MAX) const;
+
+	//The record's events, or the resampled copy the plan plays instead
+	InputSpan GetEvents() const;
+	const std::vector<Batch>& GetBatches() const;
+	//Events injected, delays not included
+	size_t GetEventCount() const;
+	//Microseconds from the start to the end of the record, the wait after its last event included.
+	//Up to the last batch if the plan stops at an invalid event.
+	uint64_t GetDuration() const;
+	//False if the record has an invalid event, the plan then stops before it
+	bool IsComplete() const;
+private:
+	InputSpan events;
+	std::vector<Batch> batches;
+	size_t eventCount = 0;
+	uint64_t duration = 0;
+	bool complete = true;
+	uint64_t revision = 0;
+	uint32_t moveRate = 0;
+	std::vector<Input> resampled;
+
+	std::unique_ptr<InputSink::Compiled> compiled;
+	std::type_index compiledFor = typeid(void);
+};
\ No newline at end of file
@@ -0,0 +1,94 @@
+#include "Player.h"
+#include "InputHandler.h"
+
+Player::Player(InputSink& sink)
+	:
+	sink(sink),
+	handler(nullptr),
+	idleEvent(true),
+	playing(false),
+	quit(false),
+	moveRate(0),
+	thrd(&Player::Run, this)
+{}
+
+Player::~Player()
+{
+	quit = true;
+	scheduler.Abort();
+	startEvent.Set();
+	thrd.join();
+}
+
+bool Player::Start(InputHandler& handler, Callback onFinished)
+{
+	if (playing.exchange(true))
+		return false;
+
+	this->handler = &handler;
+	this->onFinished = std::move(onFinished);
+
+	scheduler.Reset();
+	idleEvent.Reset();
+	startEvent.Set();
+	return true;
+}
+
+void Player::Pause()
+{
+	if (playing)
+		scheduler.Pause();
+}
+void Player::Resume()
+{
+	scheduler.Resume();
+}
+void Player::Abort()
+{
+	if (playing)
+		scheduler.Abort();
+}
+void Player::Wait()
+{
+	idleEvent.Wait();
+}
+void Player::SetMoveRate(uint32_t moveRate)
+{
+	this->moveRate = moveRate;
+}
+uint32_t Player::GetMoveRate() const
+{
+	return moveRate;
+}
+
+bool Player::IsPlaying() const
+{
+	return playing;
+}
+bool Player::IsPaused() const
+{
+	return playing && scheduler.IsPaused();
+}
+
+void Player::Run()
+{
+	for (;;)
+	{
+		startEvent.Wait();
+		if (quit)
+			return;
+
+		const bool completed = handler->Simulate(sink, scheduler, moveRate);
+		scheduler.Stop();
+
+		Callback callback = std::move(onFinished);
+		onFinished = nullptr;
+		handler = nullptr;
+		idleEvent.Set();
+		//Last, a Start on another thread may take over as soon as it sees this
+		playing = false;
+
+		if (callback && !quit)
+			callback(completed);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include "Event.h"
+#include "Scheduler.h"
+
+class InputHandler;
+class InputSink;
+
+//Plays records on its own worker thread so the capture thread keeps servicing input,
+//including the hotkeys that pause or abort a running macro
+class Player
+{
+public:
+	using Callback = std::function<void(bool completed)>;
+
+	Player(InputSink& sink);
+	~Player();
+
+	//The handler must stay alive and unmodified until playback finishes
+	bool Start(InputHandler& handler, Callback onFinished = nullptr);
+	void Pause();
+	void Resume();
+	void Abort();
+	void Wait();
+	//Mouse moves per second records are resampled to from the next Start on, 0 plays them as
+	//recorded. Bounds the injection rate of records captured from a high rate mouse.
+	void SetMoveRate(uint32_t moveRate);
+	uint32_t GetMoveRate() const;
+
+	bool IsPlaying() const;
+	bool IsPaused() const;
+private:
+	void Run();
+
+	InputSink& sink;
+	Scheduler scheduler;
+	InputHandler* handler;
+	Callback onFinished;
+
+	EventAutoReset startEvent;
+	Event idleEvent;
+	std::atomic<bool> playing, quit;
+	std::atomic<uint32_t> moveRate;
+	std::thread thrd;
+};
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "RawInp.h"
+#include "HiResClock.h"
 #include <tchar.h>
 #include <assert.h>
 
@@ -15,20 +16,16 @@ void RawInp::Input(HINSTANCE hInst, RawInp& rawInp)
 
 	MSG msg {};
 	while (GetMessage(&msg, 0, 0, 0))
-	{
-		rawInp.UpdateTimeStamp(msg.time);
 		DispatchMessage(&msg);
-	}
 }
 
 RawInp::RawInp(HINSTANCE hInst, MOUSEPROC mouseProc, KBDPROC kbdProc)
 	:
-	thrd(&RawInp::Input, hInst, std::ref(*this)),
 	wnd(hInst, WNDPROCP{ &RawInp::RawInputProc, this }),
 	mouseProc(mouseProc),
 	kbdProc(kbdProc),
-	prevTime(0),
-	curTime(0)
+	queue([this](const RawEvent* events, size_t count) { Dispatch(events, count); }),
+	thrd(&RawInp::Input, hInst, std::ref(*this))
 {}
 
 RawInp::~RawInp()
@@ -37,6 +34,11 @@ RawInp::~RawInp()
 	thrd.join();
 }
 
+const InputQueue& RawInp::GetQueue() const
+{
+	return queue;
+}
+
 bool RawInp::InitializeInputDevices()
 {
 	int deviceIndex = 0;
@@ -64,10 +66,39 @@ bool RawInp::InitializeInputDevices()
 	return RegisterRawInputDevices(rid, deviceIndex, sizeof(RAWINPUTDEVICE)) == TRUE;
 }
 
-void RawInp::UpdateTimeStamp(DWORD t)
+KbdEvent RawInp::ToKbdEvent(const RAWKEYBOARD& kbd)
+{
+	KbdEvent e;
+	e.vKey = (VKey)kbd.VKey;
+	e.makeCode = kbd.MakeCode;
+	e.down = !(kbd.Flags & RI_KEY_BREAK);
+	e.sys = (kbd.Message == WM_SYSKEYDOWN) || (kbd.Message == WM_SYSKEYUP);
+	e.E0 = (kbd.Flags & RI_KEY_E0) != 0;
+	e.E1 = (kbd.Flags & RI_KEY_E1) != 0;
+	return e;
+}
+
+MouseEvent RawInp::ToMouseEvent(const RAWMOUSE& mouse)
 {
-	prevTime = curTime;
-	curTime = t;
+	MouseEvent e;
+	e.x = mouse.lLastX;
+	e.y = mouse.lLastY;
+	e.absolute = (mouse.usFlags & MOUSE_MOVE_ABSOLUTE) != 0;
+	e.buttonFlags = mouse.usButtonFlags;
+	e.wheelDelta = (short)mouse.usButtonData;
+	return e;
+}
+
+void RawInp::Dispatch(const RawEvent* events, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		const RawEvent& e = events[i];
+		if (e.type == RawEvent::KBD)
+			kbdProc(e.kbd, e.timestamp);
+		else
+			mouseProc(e.mouse, e.timestamp);
+	}
 }
 
 
@@ -77,6 +108,9 @@ LRESULT CALLBACK RawInp::RawInputProc(HWND hWnd, UINT message, WPARAM wParam, LP
 	{
 	case WM_INPUT:
 	{
+		//MSG::time only has the resolution of the system tick, stamp on receipt instead
+		const int64_t timestamp = HiResClock::Now();
+
 		static constexpr uint32_t buffSize = 128;
 		char buffer[buffSize];
 
@@ -85,11 +119,25 @@ LRESULT CALLBACK RawInp::RawInputProc(HWND hWnd, UINT message, WPARAM wParam, LP
 		if (res == 0)
 			Window::MsgBox(_T("Call to GetRawInputData failed!"));
 
+		//Only convert and queue here, the procs run on the queue's thread so a slow
+		//handler can't hold up the message loop
 		RAWINPUT* rawinput = reinterpret_cast<RAWINPUT*>(buffer);
+		RawEvent e;
+		e.timestamp = timestamp;
 		if (rawinput->header.dwType == RIM_TYPEKEYBOARD)
-			kbdProc(rawinput->data.keyboard, curTime - prevTime);
+		{
+			e.type = RawEvent::KBD;
+			e.kbd = ToKbdEvent(rawinput->data.keyboard);
+			//SendInput events come from no device
+			e.kbd.injected = rawinput->header.hDevice == NULL;
+			queue.Push(e);
+		}
 		else if (rawinput->header.dwType == RIM_TYPEMOUSE)
-			mouseProc(rawinput->data.mouse, curTime - prevTime);
+		{
+			e.type = RawEvent::MOUSE;
+			e.mouse = ToMouseEvent(rawinput->data.mouse);
+			queue.Push(e);
+		}
 
 		DefWindowProc(hWnd, message, wParam, lParam);
 		break;
@@ -4,9 +4,12 @@
 #include <thread>
 #include "Function.h"
 #include "Window.h"
+#include "Types.h"
+#include "InputQueue.h"
 
-using MOUSEPROC = Function<void(const RAWMOUSE&, DWORD)>;
-using KBDPROC   = Function<void(const RAWKEYBOARD&, DWORD)>;
+//Events are passed with their HiResClock time stamp
+using MOUSEPROC = Function<void(const MouseEvent&, int64_t)>;
+using KBDPROC   = Function<void(const KbdEvent&, int64_t)>;
 
 class RawInp
 {
@@ -14,16 +17,21 @@ public:
 	RawInp(HINSTANCE hInst, MOUSEPROC mouseProc = (MOUSEPROC)nullptr, KBDPROC kbdProc = (KBDPROC)nullptr);
 	~RawInp();
 
+	const InputQueue& GetQueue() const;
+
 private:
 	static void Input(HINSTANCE, RawInp&);
 	LRESULT CALLBACK RawInputProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam);
 
 	bool InitializeInputDevices();
-	void UpdateTimeStamp(DWORD t);
+	static KbdEvent ToKbdEvent(const RAWKEYBOARD& kbd);
+	static MouseEvent ToMouseEvent(const RAWMOUSE& mouse);
+	void Dispatch(const RawEvent* events, size_t count);
 
-	std::thread thrd;
 	Window wnd;
 	MOUSEPROC mouseProc;
 	KBDPROC kbdProc;
-	DWORD prevTime, curTime;
+	InputQueue queue;
+	//Started last so everything the capture thread touches is already constructed
+	std::thread thrd;
 };
\ No newline at end of file
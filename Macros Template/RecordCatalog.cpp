@@ -0,0 +1,135 @@
+#include "RecordCatalog.h"
+#include "File.h"
+#include <cstring>
+
+//Bounds checked reads of the catalog, any read past the end fails the whole load
+class CatalogReader
+{
+public:
+	CatalogReader(const std::vector<char>& data)
+		:
+		data(data),
+		pos(0)
+	{}
+
+	template<typename T>
+	bool Read(T& val)
+	{
+		return Read(&val, sizeof(T));
+	}
+	bool Read(void* dst, size_t size)
+	{
+		if (size > data.size() - pos)
+			return false;
+
+		std::memcpy(dst, data.data() + pos, size);
+		pos += size;
+		return true;
+	}
+private:
+	const std::vector<char>& data;
+	size_t pos;
+};
+
+template<typename T>
+static void Write(std::vector<char>& data, const T& val)
+{
+	const char* bytes = (const char*)&val;
+	data.insert(data.end(), bytes, bytes + sizeof(T));
+}
+
+bool RecordCatalog::Load(const std::string& filename)
+{
+	entries.clear();
+
+	std::vector<char> data;
+	if (!File::ReadFile(filename, data))
+		return false;
+
+	CatalogReader reader(data);
+	char magic[sizeof(MAGIC)];
+	uint32_t version, count;
+	if (!reader.Read(magic) || (std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) ||
+		!reader.Read(version) || (version != VERSION) || !reader.Read(count))
+		return false;
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		uint16_t nameLength;
+		std::string name;
+		Entry entry;
+		uint8_t nKeys;
+
+		bool res = reader.Read(nameLength);
+		if (res)
+		{
+			name.resize(nameLength);
+			res = reader.Read(name.data(), nameLength);
+		}
+		res = res && reader.Read(entry.size) && reader.Read(entry.mtime) &&
+			reader.Read(entry.eventCount) && reader.Read(entry.duration) && reader.Read(nKeys);
+		if (res)
+		{
+			entry.toggleVKeys.resize(nKeys);
+			res = reader.Read(entry.toggleVKeys.data(), nKeys);
+		}
+
+		if (!res)
+		{
+			entries.clear();
+			return false;
+		}
+		entries[std::move(name)] = std::move(entry);
+	}
+	return true;
+}
+
+bool RecordCatalog::Save(const std::string& filename) const
+{
+	std::vector<char> data;
+	data.insert(data.end(), MAGIC, MAGIC + sizeof(MAGIC));
+	Write(data, VERSION);
+	Write(data, (uint32_t)entries.size());
+
+	for (const auto& it : entries)
+	{
+		const Entry& entry = it.second;
+		Write(data, (uint16_t)it.first.size());
+		data.insert(data.end(), it.first.begin(), it.first.end());
+		Write(data, entry.size);
+		Write(data, entry.mtime);
+		Write(data, entry.eventCount);
+		Write(data, entry.duration);
+		Write(data, (uint8_t)entry.toggleVKeys.size());
+		data.insert(data.end(), entry.toggleVKeys.begin(), entry.toggleVKeys.end());
+	}
+
+	return File::WriteFile(filename, data);
+}
+
+const RecordCatalog::Entry* RecordCatalog::Find(const std::string& name, uint64_t size, int64_t mtime) const
+{
+	const auto it = entries.find(name);
+	if ((it == entries.end()) || (it->second.size != size) || (it->second.mtime != mtime))
+		return nullptr;
+	return &it->second;
+}
+
+void RecordCatalog::Set(const std::string& name, Entry entry)
+{
+	//Left out rather than truncated, the file is then read every startup
+	if ((name.size() > UINT16_MAX) || (entry.toggleVKeys.size() > UINT8_MAX))
+		return;
+
+	entries[name] = std::move(entry);
+}
+
+void RecordCatalog::Clear()
+{
+	entries.clear();
+}
+
+size_t RecordCatalog::GetCount() const
+{
+	return entries.size();
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "Types.h"
+
+//What the record list needs of every record file, saved next to the records so startup only
+//has to open the files that changed since the catalog was written.
+//
+//Layout, every field little endian:
+//
+//	magic, uint32 version, uint32 entry count
+//	per entry: uint16 name length, name, uint64 size, int64 mtime, uint64 event count,
+//	           uint64 duration, uint8 toggle key count, toggle keys
+class RecordCatalog
+{
+public:
+	static constexpr char MAGIC[4] = { 'M', 'C', 'A', 'T' };
+	//2 since delays are part of the events, which changed the event counts
+	static constexpr uint32_t VERSION = 2;
+	//Not a .dat so it isn't listed as a record
+	static constexpr const char* FILENAME = "catalog.idx";
+
+	struct Entry
+	{
+		uint64_t size = 0;
+		int64_t mtime = 0;
+		VKeyList toggleVKeys;
+		uint64_t eventCount = 0;
+		uint64_t duration = 0;	//Microseconds
+	};
+
+	//A missing or malformed catalog loads as empty, every record is then read again
+	bool Load(const std::string& filename);
+	bool Save(const std::string& filename) const;
+
+	//The entry for name, if the file still has the size and write time it had when cataloged
+	const Entry* Find(const std::string& name, uint64_t size, int64_t mtime) const;
+	//Names or toggle combos too long for the layout aren't cataloged
+	void Set(const std::string& name, Entry entry);
+	void Clear();
+	size_t GetCount() const;
+private:
+	std::map<std::string, Entry> entries;
+};
\ No newline at end of file
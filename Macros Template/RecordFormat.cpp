@@ -0,0 +1,30 @@
+#include "RecordFormat.h"
+#include <cstring>
+
+bool RecordHeader::Matches(const char* data, size_t size)
+{
+	return (size >= sizeof(MAGIC)) && (std::memcmp(data, MAGIC, sizeof(MAGIC)) == 0);
+}
+
+bool RecordHeader::Check(size_t fileSize, std::string& error) const
+{
+	if (std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0)
+		error = "not a v2 or v3 record";
+	else if ((version != VERSION) && (version != VERSION_V2))
+		error = "unsupported version " + std::to_string(version);
+	else if ((headerSize < sizeof(RecordHeader)) || (headerSize > fileSize))
+		error = "bad header size " + std::to_string(headerSize);
+	else if (eventSize != ((version == VERSION) ? sizeof(Input) : sizeof(RecordEventV2)))
+		error = "bad event size " + std::to_string(eventSize);
+	else if (nToggleKeys > MAX_TOGGLE_KEYS)
+		error = "bad toggle key count " + std::to_string(nToggleKeys);
+	else if ((indexOffset < headerSize) || (indexOffset > fileSize) || ((fileSize - indexOffset) / sizeof(RecordBlock) < blockCount))
+		error = "bad block index";
+	else if ((eventsPerBlock == 0) || (eventCount > (indexOffset - headerSize) / eventSize) ||
+		(blockCount != (eventCount + eventsPerBlock - 1) / eventsPerBlock))
+		error = "bad event count " + std::to_string(eventCount);
+	else
+		return true;
+
+	return false;
+}
\ No newline at end of file
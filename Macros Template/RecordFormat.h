@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "InputData.h"
+
+//Layout of a v3 record file, every field little endian:
+//
+//	RecordHeader
+//	blocks of up to eventsPerBlock Input records, stored as they are in memory
+//	RecordBlock index with one entry per block, at indexOffset
+//
+//v2 files have the same layout with RecordEventV2 records, whose waits are DelayData events of
+//their own. They are converted when decoded and can't be mapped.
+//
+//v1 files have no header, they start with the toggle key count followed by the keys and a
+//stream of uuid + fields as encoded by the InputData codecs.
+struct RecordHeader
+{
+	static constexpr char MAGIC[4] = { 'M', 'R', 'E', 'C' };
+	static constexpr uint16_t VERSION = 3;
+	static constexpr uint16_t VERSION_V2 = 2;
+	static constexpr uint32_t EVENTS_PER_BLOCK = 4096;
+	static constexpr size_t MAX_TOGGLE_KEYS = 19;
+
+	//True if data starts with the magic shared by v2 and v3
+	static bool Matches(const char* data, size_t size);
+	//Validates the header against the size of the whole file, either version
+	bool Check(size_t fileSize, std::string& error) const;
+
+	char magic[4];
+	uint16_t version;
+	uint16_t headerSize;
+	uint16_t eventSize;
+	uint16_t reserved;
+	uint32_t eventsPerBlock;
+	uint64_t eventCount;
+	uint64_t duration;	//Sum of all delays in microseconds
+	uint64_t indexOffset;
+	uint32_t blockCount;
+	uint8_t nToggleKeys;
+	VKey toggleKeys[MAX_TOGGLE_KEYS];
+};
+
+struct RecordBlock
+{
+	uint64_t offset;
+	uint64_t startTime;	//Microseconds from the start of the record to the block's first event, its delay included
+	uint32_t eventCount;
+	uint32_t reserved;
+};
+
+//Event of a v2 file, an Input without its delay. A DelayData keeps its wait in x.
+struct RecordEventV2
+{
+	uint8_t type;
+	uint8_t flags;
+	uint16_t key;
+	int32_t x, y;
+};
+
+static_assert(sizeof(RecordEventV2) == 12, "RecordEventV2 is part of the file format");
+static_assert(sizeof(RecordHeader) == 64, "RecordHeader is part of the file format");
+static_assert(sizeof(RecordBlock) == 24, "RecordBlock is part of the file format");
\ No newline at end of file
@@ -1,87 +1,210 @@
 #include "RecordList.h"
 #include "File.h"
+#include "ParallelFor.h"
+#include "RecordFormat.h"
+#include <algorithm>
+#include <chrono>
 
-RecordList::InputRecord::InputRecord(const std::vector<TCHAR>& toggleVKeys) noexcept
+static uint64_t MicroSince(std::chrono::steady_clock::time_point start)
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+RecordList::InputRecord::InputRecord(const VKeyList& toggleVKeys) noexcept
 	:
 	handler(toggleVKeys)
 {}
 
-RecordList::InputRecord::InputRecord(InputRecord&& ir) noexcept
+RecordList::RecordList(InputSink& sink)
 	:
-	handler(std::move(ir.handler)),
-	filename(std::move(ir.filename))
-{
-	memset(&ir, 0, sizeof(InputRecord));
-}
+	currentRecord(RecordList::INVALID),
+	player(sink)
+{}
+
+RecordList::~RecordList(){}
 
-RecordList::InputRecord& RecordList::InputRecord::operator=(RecordList::InputRecord&& ir) noexcept
+bool RecordList::Initialize(const std::string& workingDir, bool preload, unsigned threads)
 {
-	if (this != &ir)
+	const auto start = std::chrono::steady_clock::now();
+
+	const std::string catalogFile = (fs::path(workingDir) / RecordCatalog::FILENAME).string();
+	RecordCatalog catalog;
+	catalog.Load(catalogFile);
+
+	//Directory order isn't specified, sorted so records get the same index every run
+	auto fileList = File::GetFileInfoList(workingDir, ".dat");
+	std::sort(fileList.begin(), fileList.end(), [](const File::FileInfo& a, const File::FileInfo& b)
 	{
-		handler = std::move(ir.handler);
-		filename = std::move(ir.filename);
-		memset(&ir, 0, sizeof(InputRecord));
+		return a.path < b.path;
+	});
+
+	//Every file is read into its own slot, then merged in file order
+	std::vector<InputRecord> listed(fileList.size());
+	std::vector<std::string> names(fileList.size());
+	loadReports.assign(fileList.size(), {});
+
+	ParallelFor(fileList.size(), [&](size_t i)
+	{
+		const auto fileStart = std::chrono::steady_clock::now();
+		const File::FileInfo& file = fileList[i];
+		names[i] = fs::path(file.path).lexically_relative(workingDir).generic_string();
+
+		InputRecord& record = listed[i];
+		record.filename = file.path;
+		record.loaded = preload;
+
+		InputHandler& handler = record.handler;
+		const char* filename = record.filename.c_str();
+		const RecordCatalog::Entry* entry = catalog.Find(names[i], file.size, file.mtime);
+
+		LoadReport& report = loadReports[i];
+		report.filename = file.path;
+
+		bool res = true;
+		if (entry && !preload)
+		{
+			handler.SetHeader(entry->toggleVKeys, entry->eventCount, entry->duration);
+			report.cached = true;
+		}
+		else if (preload)
+		{
+			//v3 records are mapped and played from the file, older records are decoded
+			res = handler.Map(filename) || handler.Load(filename);
+		}
+		else if ((res = handler.LoadHeader(filename)) && (handler.GetFormatVersion() != RecordHeader::VERSION))
+		{
+			//Only the converted events give an older record's length, they are dropped again once counted
+			res = handler.Load(filename);
+			if (res)
+				handler.SetHeader(handler.GetToggleVKeys(), handler.GetEventCount(), handler.GetDuration());
+		}
+
+		if (!res)
+			report.error = handler.GetLoadError();
+		report.events = handler.GetEventCount();
+		report.micro = MicroSince(fileStart);
+	}, threads);
+
+	//Rebuilt from what was listed so entries of removed or broken files are dropped
+	RecordCatalog updated;
+	bool catalogChanged = false;
+	for (size_t i = 0, size = listed.size(); i < size; ++i)
+	{
+		if (!loadReports[i].error.empty())
+		{
+			++loadStats.failed;
+			continue;
+		}
+
+		const InputHandler& handler = listed[i].handler;
+		RecordCatalog::Entry entry;
+		entry.size = fileList[i].size;
+		entry.mtime = fileList[i].mtime;
+		entry.toggleVKeys = handler.GetToggleVKeys();
+		entry.eventCount = handler.GetEventCount();
+		entry.duration = handler.GetDuration();
+		updated.Set(names[i], std::move(entry));
+
+		if (loadReports[i].cached)
+			++loadStats.cached;
+		if (!catalog.Find(names[i], fileList[i].size, fileList[i].mtime))
+			catalogChanged = true;
+
+		records.push_back(std::move(listed[i]));
 	}
-	return *this;
+
+	if (catalogChanged || (updated.GetCount() != catalog.GetCount()))
+		updated.Save(catalogFile);
+
+	IndexHotkeys();
+	loadStats.records = records.size();
+	loadStats.initializeMicro = MicroSince(start);
+	return loadStats.failed == 0;
 }
 
-RecordList::RecordList()
-	:
-	currentRecord(RecordList::INVALID),
-	simulating(false)
-{}
+bool RecordList::LoadRecord(int index)
+{
+	InputRecord& record = records[index];
+	if (record.loaded)
+		return record.handler.GetLoadError().empty();
 
-RecordList::~RecordList(){}
+	const auto start = std::chrono::steady_clock::now();
+
+	//v3 records are mapped and played from the file, older records are decoded
+	record.loaded = true;
+	const bool res = record.handler.Map(record.filename.c_str()) || record.handler.Load(record.filename.c_str());
 
-bool RecordList::Initialize(const TCHAR* workingDir)
+	loadStats.lastLoadMicro = MicroSince(start);
+	loadStats.loadMicro += loadStats.lastLoadMicro;
+	++loadStats.loaded;
+	return res;
+}
+
+int RecordList::SelectRecord(const KbdEvent& kbd, const Keys& keys, int64_t timestamp)
 {
-	auto fileList = File::GetFileList(workingDir);
-	for (size_t i = 0, size = fileList.size(); i < size; ++i)
-	{
-		records.emplace_back();
-		records[i].handler.Load(fileList[i].c_str());
-		records[i].filename = std::move(fileList[i]);
-	}
-	return true;
+	const int index = hotkeys.OnKey(kbd, keys, timestamp);
+	if (index == SequenceMatcher::NONE)
+		return RecordList::INVALID;
+
+	return LoadRecord(index) ? (currentRecord = index) : RecordList::INVALID;
 }
 
-int RecordList::SelectRecord(const RAWKEYBOARD& kbd)
+bool RecordList::SimulateRecord(Player::Callback onFinished)
 {
-	for (size_t i = 0, size = records.size(); i < size; ++i)
-	{
-		if (records[i].handler.CheckForToggle(kbd))
-			return currentRecord = i;
-	}
-	return RecordList::INVALID;
+	if ((currentRecord == RecordList::INVALID) || IsRecording() || !LoadRecord(currentRecord))
+		return false;
+
+	return player.Start(records[currentRecord].handler, std::move(onFinished));
 }
 
-void RecordList::SimulateRecord()
+void RecordList::PauseSimulation()
 {
-	if (currentRecord != RecordList::INVALID)
-	{
-		simulating = true;
-		records[currentRecord].handler.Simulate();
-		simulating = false;
-	}
+	player.Pause();
+}
+void RecordList::ResumeSimulation()
+{
+	player.Resume();
+}
+void RecordList::AbortSimulation()
+{
+	player.Abort();
+}
+void RecordList::SetMoveRate(uint32_t moveRate)
+{
+	player.SetMoveRate(moveRate);
+}
+uint32_t RecordList::GetMoveRate() const
+{
+	return player.GetMoveRate();
 }
 
-bool RecordList::AddRecord(const std::vector<TCHAR>& toggleVKeys)
+bool RecordList::AddRecord(const VKeyList& toggleVKeys)
 {
+	//The player holds a pointer into records
+	if (IsSimulating())
+		return false;
+
 	const int index = FindRecord(toggleVKeys);
 	if (index != RecordList::INVALID)
 		return false;
 
 	currentRecord = records.size();
 	records.emplace_back(toggleVKeys);
+	IndexHotkeys();
 	return true;
 }
 
-bool RecordList::DeleteRecord(const std::vector<TCHAR>& toggleVKeys)
+bool RecordList::DeleteRecord(const VKeyList& toggleVKeys)
 {
+	if (IsSimulating())
+		return false;
+
 	const int index = FindRecord(toggleVKeys);
 	if (index == RecordList::INVALID)
 		return false;
 
+	//Unmap first, a mapped file can't be deleted on Windows
+	records[index].handler.Cleanup();
 	if(!records[index].filename.empty())
 		fs::remove(records[index].filename.c_str());
 
@@ -93,11 +216,12 @@ bool RecordList::DeleteRecord(const std::vector<TCHAR>& toggleVKeys)
 
 	records.pop_back();
 	currentRecord = RecordList::INVALID;
+	IndexHotkeys();
 
 	return true;
 }
 
-int RecordList::FindRecord(const std::vector<TCHAR>& toggleVKeys) const
+int RecordList::FindRecord(const VKeyList& toggleVKeys) const
 {
 	for (size_t i = 0, size = records.size(); i < size; ++i)
 	{
@@ -107,7 +231,42 @@ int RecordList::FindRecord(const std::vector<TCHAR>& toggleVKeys) const
 	return RecordList::INVALID;
 }
 
-Input* RecordList::GetBack() const
+void RecordList::IndexHotkeys()
+{
+	hotkeys.Clear();
+	for (size_t i = 0, size = records.size(); i < size; ++i)
+		hotkeys.Add(records[i].handler.GetToggleVKeys(), i);
+	hotkeys.Build();
+}
+
+void RecordList::AddDelayUntil(int64_t timestamp)
+{
+	if (currentRecord != RecordList::INVALID)
+		records[currentRecord].handler.AddDelayUntil(timestamp);
+}
+
+void RecordList::AddRelativeMove(int x, int y, int64_t timestamp)
+{
+	if (currentRecord != RecordList::INVALID)
+		records[currentRecord].handler.AddRelativeMove(x, y, timestamp);
+}
+
+void RecordList::SetMotionCoalescing(const InputHandler::MotionCoalescing& coalescing)
+{
+	this->coalescing = coalescing;
+}
+const InputHandler::MotionCoalescing& RecordList::GetMotionCoalescing() const
+{
+	return coalescing;
+}
+InputHandler::MotionStats RecordList::GetMotionStats() const
+{
+	if (currentRecord != RecordList::INVALID)
+		return records[currentRecord].handler.GetMotionStats();
+	return {};
+}
+
+Input* RecordList::GetBack()
 {
 	return (currentRecord != RecordList::INVALID) ? records[currentRecord].handler.GetBack() : nullptr;
 }
@@ -129,8 +288,12 @@ void RecordList::Save()
 
 void RecordList::StartRecording()
 {
-	if (currentRecord != RecordList::INVALID)
+	if ((currentRecord != RecordList::INVALID) && !IsSimulating())
+	{
+		records[currentRecord].handler.SetMotionCoalescing(coalescing);
 		records[currentRecord].handler.StartRecording();
+		records[currentRecord].loaded = true;
+	}
 }
 
 void RecordList::StopRecording()
@@ -147,7 +310,11 @@ bool RecordList::IsRecording() const
 }
 bool RecordList::IsSimulating() const
 {
-	return simulating;
+	return player.IsPlaying();
+}
+bool RecordList::IsSimulationPaused() const
+{
+	return player.IsPaused();
 }
 
 bool RecordList::HasRecorded() const
@@ -157,6 +324,19 @@ bool RecordList::HasRecorded() const
 	return false;
 }
 
+size_t RecordList::GetRecordCount() const
+{
+	return records.size();
+}
+const RecordList::LoadStats& RecordList::GetLoadStats() const
+{
+	return loadStats;
+}
+const std::vector<RecordList::LoadReport>& RecordList::GetLoadReports() const
+{
+	return loadReports;
+}
+
 int RecordList::GetCurrentRecord() const
 {
 	return currentRecord;
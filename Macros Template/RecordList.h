@@ -1,5 +1,10 @@
 #pragma once
 #include "InputHandler.h"
+#include "Keys.h"
+#include "Player.h"
+#include "RecordCatalog.h"
+#include "SequenceMatcher.h"
+#include <cstdint>
 #include <string>
 
 class RecordList
@@ -7,7 +12,29 @@ class RecordList
 public:
 	static constexpr int INVALID = -1;
 
-	RecordList();	
+	//Records are listed from their headers at startup and their events loaded on first use
+	struct LoadStats
+	{
+		size_t records = 0;
+		size_t failed = 0;
+		size_t cached = 0;	//Listed from the catalog without opening the file
+		uint64_t initializeMicro = 0;
+		size_t loaded = 0;
+		uint64_t loadMicro = 0;
+		uint64_t lastLoadMicro = 0;
+	};
+
+	//Outcome of each file read by Initialize, in the order the records were listed
+	struct LoadReport
+	{
+		std::string filename;
+		std::string error;	//Empty if the file was listed
+		uint64_t micro = 0;
+		size_t events = 0;
+		bool cached = false;
+	};
+
+	RecordList(InputSink& sink);
 	~RecordList();
 
 	template<typename T, typename... Args>
@@ -16,14 +43,36 @@ public:
 		records[currentRecord].handler.Add<T, Args...>(std::forward<Args>(vals)...);
 	}
 
-	bool Initialize(const TCHAR* workingDir);
-	int SelectRecord(const RAWKEYBOARD& kbd);
-	bool AddRecord(const std::vector<TCHAR>& toggleVKeys);
-	bool DeleteRecord(const std::vector<TCHAR>& toggleVKeys);
+	//Reads the records of a directory on a thread per core, 0 threads uses one per core.
+	//Records unchanged since the directory's catalog was saved are listed from it, the others
+	//from their headers, v1 and v2 records decoded once to catalog them. Events are only kept if
+	//preload is set. Files that fail are reported and left out.
+	bool Initialize(const std::string& workingDir, bool preload = false, unsigned threads = 0);
+	//Loads the events of a record listed by Initialize, does nothing if they are already loaded
+	bool LoadRecord(int index);
+	//Selects the record whose trigger kbd completes, matched against the keys held in keys.
+	//timestamp is in HiResClock nanoseconds, for triggers of several steps.
+	int SelectRecord(const KbdEvent& kbd, const Keys& keys, int64_t timestamp);
+	bool AddRecord(const VKeyList& toggleVKeys);
+	bool DeleteRecord(const VKeyList& toggleVKeys);
+
+	bool SimulateRecord(Player::Callback onFinished = nullptr);
+	void PauseSimulation();
+	void ResumeSimulation();
+	void AbortSimulation();
+	//Mouse moves per second records are played at, see Player::SetMoveRate
+	void SetMoveRate(uint32_t moveRate);
+	uint32_t GetMoveRate() const;
 
-	void SimulateRecord();
+	void AddDelayUntil(int64_t timestamp);
+	void AddRelativeMove(int x, int y, int64_t timestamp);
+	//Applies to records started from now on
+	void SetMotionCoalescing(const InputHandler::MotionCoalescing& coalescing);
+	const InputHandler::MotionCoalescing& GetMotionCoalescing() const;
+	//Of the current record's last recording
+	InputHandler::MotionStats GetMotionStats() const;
 
-	Input* GetBack() const;
+	Input* GetBack();
 	void PopBack();
 
 	void Save();
@@ -33,24 +82,36 @@ public:
 
 	bool IsRecording() const;
 	bool IsSimulating() const;
+	bool IsSimulationPaused() const;
 	bool HasRecorded() const;
 
 	int GetCurrentRecord() const;
+	size_t GetRecordCount() const;
+	const LoadStats& GetLoadStats() const;
+	const std::vector<LoadReport>& GetLoadReports() const;
 private:
-	int FindRecord(const std::vector<TCHAR>& toggleVKeys) const;
+	int FindRecord(const VKeyList& toggleVKeys) const;
+	//Rebuilt whenever records are added, removed or reordered
+	void IndexHotkeys();
 
 	struct InputRecord
 	{
 		InputRecord() = default;
-		InputRecord(InputRecord&& ir) noexcept;
-		InputRecord& operator=(InputRecord&& ir) noexcept;
-		InputRecord(const std::vector<TCHAR>& toggleVKeys) noexcept;
+		InputRecord(InputRecord&& ir) noexcept = default;
+		InputRecord& operator=(InputRecord&& ir) noexcept = default;
+		InputRecord(const VKeyList& toggleVKeys) noexcept;
 
 		InputHandler handler;
 		std::string filename;
+		bool loaded = true;
 	};
 
 	std::vector<InputRecord> records;
+	SequenceMatcher hotkeys;
 	int currentRecord;
-	bool simulating;
+	LoadStats loadStats;
+	InputHandler::MotionCoalescing coalescing;
+	std::vector<LoadReport> loadReports;
+	//Declared after records so playback is stopped before they are destroyed
+	Player player;
 };
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include "Scheduler.h"
+#include <thread>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <timeapi.h>
+#endif
+
+Scheduler::Scheduler(Clock::duration spinThreshold)
+	:
+	start(Clock::now()),
+	deadline(start),
+	spinThreshold(spinThreshold),
+	maxLateness(Clock::duration::zero()),
+	timerRaised(false),
+	paused(false),
+	aborted(false)
+{}
+
+Scheduler::~Scheduler()
+{
+	Stop();
+}
+
+void Scheduler::Start()
+{
+#ifdef _WIN32
+	//Default timer resolution is ~15.6ms which would leave most of every wait to the spin.
+	//It is raised system wide, so only for as long as something is playing.
+	if (!timerRaised)
+		timeBeginPeriod(1);
+#endif
+	timerRaised = true;
+	start = deadline = Clock::now();
+	maxLateness = Clock::duration::zero();
+}
+
+void Scheduler::Stop()
+{
+#ifdef _WIN32
+	if (timerRaised)
+		timeEndPeriod(1);
+#endif
+	timerRaised = false;
+}
+
+void Scheduler::Advance(Clock::duration delay)
+{
+	deadline += delay;
+}
+void Scheduler::AdvanceTo(Clock::duration offset)
+{
+	deadline = start + offset;
+}
+
+bool Scheduler::Wait()
+{
+	for (;;)
+	{
+		if (aborted)
+			return false;
+
+		if (paused)
+		{
+			WaitWhilePaused();
+			continue;
+		}
+
+		const auto wake = deadline - spinThreshold;
+		if ((Clock::now() < wake) && interrupt.WaitUntil(wake))
+		{
+			//Woken by a command, re-check the flags before sleeping again
+			interrupt.Reset();
+			continue;
+		}
+		break;
+	}
+
+	auto now = Clock::now();
+	while (now < deadline)
+	{
+		if (aborted || paused)
+			return Wait();
+
+		std::this_thread::yield();
+		now = Clock::now();
+	}
+
+	if ((now - deadline) > maxLateness)
+		maxLateness = now - deadline;
+
+	return true;
+}
+
+void Scheduler::WaitWhilePaused()
+{
+	const auto pauseStart = Clock::now();
+	while (paused && !aborted)
+	{
+		interrupt.Wait();
+		interrupt.Reset();
+	}
+
+	//Shift the timeline so the remaining events keep their spacing
+	const auto pausedFor = Clock::now() - pauseStart;
+	start += pausedFor;
+	deadline += pausedFor;
+}
+
+void Scheduler::Reset()
+{
+	paused = false;
+	aborted = false;
+	interrupt.Reset();
+}
+void Scheduler::Pause()
+{
+	paused = true;
+	interrupt.Set();
+}
+void Scheduler::Resume()
+{
+	paused = false;
+	interrupt.Set();
+}
+void Scheduler::Abort()
+{
+	aborted = true;
+	interrupt.Set();
+}
+
+bool Scheduler::IsPaused() const
+{
+	return paused;
+}
+bool Scheduler::IsAborted() const
+{
+	return aborted;
+}
+
+Scheduler::Clock::time_point Scheduler::GetStart() const
+{
+	return start;
+}
+Scheduler::Clock::time_point Scheduler::GetDeadline() const
+{
+	return deadline;
+}
+Scheduler::Clock::duration Scheduler::GetMaxLateness() const
+{
+	return maxLateness;
+}
\ No newline at end of file
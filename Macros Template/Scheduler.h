@@ -0,0 +1,54 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include "Event.h"
+
+//Paces playback against absolute deadlines measured from Start(), so oversleep and the time
+//spent injecting never accumulate over a long record. Waits sleep until shortly before the
+//deadline and spin the rest of the way.
+//Pause, Resume and Abort may be called from any thread and interrupt a pending Wait.
+class Scheduler
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+#ifdef _WIN32
+	static constexpr Clock::duration DEFAULT_SPIN = std::chrono::milliseconds(2);
+#else
+	static constexpr Clock::duration DEFAULT_SPIN = std::chrono::microseconds(500);
+#endif
+
+	Scheduler(Clock::duration spinThreshold = DEFAULT_SPIN);
+	~Scheduler();
+
+	//Start raises the system timer resolution until Stop or destruction
+	void Start();
+	void Stop();
+	void Advance(Clock::duration delay);
+	//Sets the deadline to offset from Start()
+	void AdvanceTo(Clock::duration offset);
+	//Returns false if playback was aborted
+	bool Wait();
+
+	void Reset();
+	void Pause();
+	void Resume();
+	void Abort();
+
+	bool IsPaused() const;
+	bool IsAborted() const;
+
+	Clock::time_point GetStart() const;
+	Clock::time_point GetDeadline() const;
+	Clock::duration GetMaxLateness() const;
+private:
+	void WaitWhilePaused();
+
+	Clock::time_point start, deadline;
+	Clock::duration spinThreshold;
+	Clock::duration maxLateness;
+	bool timerRaised;
+
+	Event interrupt;
+	std::atomic<bool> paused, aborted;
+};
\ No newline at end of file
@@ -0,0 +1,142 @@
+#include "SequenceMatcher.h"
+#include "CheckKey.h"
+#include <algorithm>
+#include <queue>
+
+void SequenceMatcher::Clear()
+{
+	steps.Clear();
+	stepIds.clear();
+	heldKeys.Reset();
+	nodes.assign(1, Node());
+	edges.clear();
+	count = 0;
+	state = 0;
+}
+
+int SequenceMatcher::AddStep(const VKeyList& vKeys)
+{
+	//Held keys in any order are the same step
+	VKeyList step(vKeys.begin(), vKeys.end() - 1);
+	std::sort(step.begin(), step.end());
+	step.erase(std::unique(step.begin(), step.end()), step.end());
+	step.erase(std::remove(step.begin(), step.end(), vKeys.back()), step.end());
+	step.push_back(vKeys.back());
+
+	const auto it = stepIds.find(step);
+	if (it != stepIds.end())
+		return it->second;
+
+	const int id = (int)stepIds.size();
+	stepIds.emplace(step, id);
+	steps.Add(step, id);
+	for (auto it = step.begin(), end = step.end() - 1; it != end; ++it)
+		heldKeys.Set(*it, true);
+	return id;
+}
+
+void SequenceMatcher::Add(const VKeyList& vKeys, int index)
+{
+	int node = 0;
+	for (auto begin = vKeys.begin(); begin != vKeys.end();)
+	{
+		const auto end = std::find(begin, vKeys.end(), SEPARATOR);
+		if (begin != end)
+		{
+			const int step = AddStep(VKeyList(begin, end));
+			const auto edge = edges.emplace(Edge(node, step), (int)nodes.size());
+			if (edge.second)
+				nodes.emplace_back();
+			node = edge.first->second;
+		}
+		begin = (end == vKeys.end()) ? end : end + 1;
+	}
+
+	if ((node != 0) && (nodes[node].index == NONE))
+	{
+		nodes[node].index = index;
+		++count;
+	}
+}
+
+int SequenceMatcher::Next(int node, int step) const
+{
+	for (;;)
+	{
+		const auto it = edges.find(Edge(node, step));
+		if (it != edges.end())
+			return it->second;
+		if (node == 0)
+			return 0;
+		node = nodes[node].fail;
+	}
+}
+
+void SequenceMatcher::Build()
+{
+	//Children by parent so the trie can be walked breadth first
+	std::vector<std::vector<std::pair<int, int>>> children(nodes.size());
+	for (const auto& it : edges)
+		children[it.first >> 32].emplace_back((int)(it.first & 0xFFFFFFFF), it.second);
+
+	std::queue<int> queue;
+	for (const auto& it : children[0])
+	{
+		nodes[it.second].fail = 0;
+		queue.push(it.second);
+	}
+
+	while (!queue.empty())
+	{
+		const int node = queue.front();
+		queue.pop();
+
+		Node& n = nodes[node];
+		if (n.index == NONE)
+			n.index = nodes[n.fail].index;
+
+		for (const auto& it : children[node])
+		{
+			nodes[it.second].fail = Next(n.fail, it.first);
+			queue.push(it.second);
+		}
+	}
+	state = 0;
+}
+
+int SequenceMatcher::OnKey(const KbdEvent& kbd, const Keys& keys, int64_t timestamp)
+{
+	//Holding a key down doesn't count as pressing it again
+	if (!CheckKey::KeyDown(kbd) || keys.IsRepeat())
+		return NONE;
+
+	if ((state != 0) && (timestamp - lastStep > timeout))
+		state = 0;
+
+	const int step = steps.Find(kbd, keys.GetState());
+	if (step == HotkeyIndex::NONE)
+	{
+		//A modifier on its way to the next step keeps the sequence, any other key breaks it
+		if (!heldKeys.Test(kbd.vKey) && !heldKeys.Test(Keys::SidedVKey(kbd)))
+			state = 0;
+		return NONE;
+	}
+
+	state = Next(state, step);
+	lastStep = timestamp;
+	return nodes[state].index;
+}
+
+void SequenceMatcher::SetTimeout(int64_t timeout)
+{
+	this->timeout = timeout;
+}
+
+size_t SequenceMatcher::GetCount() const
+{
+	return count;
+}
+size_t SequenceMatcher::GetStateCount() const
+{
+	return nodes.size();
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include "HotkeyIndex.h"
+#include "Keys.h"
+
+//Record triggers made of one or more steps, each step a combo as matched by HotkeyIndex, like
+//CONTROL+K then M or a double tap of F5. All triggers are built into one Aho-Corasick automaton
+//over the steps, so every key press advances a single state whatever the number of triggers.
+//
+//In a toggle key list the steps are separated by SEPARATOR, which isn't a virtual key.
+class SequenceMatcher
+{
+public:
+	static constexpr int NONE = -1;
+	static constexpr VKey SEPARATOR = 0x00;
+	static constexpr int64_t DEFAULT_TIMEOUT = 1000000000;	//1s in HiResClock nanoseconds
+
+	void Clear();
+	//Triggers with an index already added for the same steps are ignored. Call Build once all
+	//triggers are added.
+	void Add(const VKeyList& vKeys, int index);
+	void Build();
+
+	//Advances on a key event and returns the index of the trigger it completes, the longest one
+	//if several end on it. keys must already have seen kbd, timestamp is in HiResClock nanoseconds.
+	int OnKey(const KbdEvent& kbd, const Keys& keys, int64_t timestamp);
+	//Longest time between two steps of a trigger before it has to be started over
+	void SetTimeout(int64_t timeout);
+
+	size_t GetCount() const;
+	size_t GetStateCount() const;
+private:
+	struct Node
+	{
+		int fail = 0;
+		int index = NONE;	//Trigger ending here, or at the longest suffix that ends one
+	};
+
+	int AddStep(const VKeyList& vKeys);
+	int Next(int state, int step) const;
+
+	static uint64_t Edge(int state, int step)
+	{
+		return (uint64_t(uint32_t(state)) << 32) | uint32_t(step);
+	}
+
+	HotkeyIndex steps;
+	std::map<VKeyList, int> stepIds;
+	//Keys held by any step, pressing one of them alone doesn't break a sequence
+	KeyMask heldKeys;
+
+	std::vector<Node> nodes = std::vector<Node>(1);
+	std::unordered_map<uint64_t, int> edges;
+	size_t count = 0;
+
+	int state = 0;
+	int64_t lastStep = 0;
+	int64_t timeout = DEFAULT_TIMEOUT;
+};
\ No newline at end of file
@@ -1,26 +1,28 @@
 #include "SimInp.h"
 #include "Keys.h"
+#include "PlaybackPlan.h"
+#include <Windows.h>
 #include <stdlib.h>
 #include <memory>
 #include <thread>
 #include <chrono>
 
 //Simulate Keyboard functions
-bool SimInp::SendKbdDown(WORD key)
+bool SimInp::SendKbdDown(uint16_t key)
 {
 	INPUT input{ INPUT_KEYBOARD };
 	input.ki = { key, NULL, NULL, 0, NULL };
 	return SendInput(1, &input, sizeof(INPUT)) == 1;
 }
 
-bool SimInp::SendKbdUp(WORD key)
+bool SimInp::SendKbdUp(uint16_t key)
 {
 	INPUT input{ INPUT_KEYBOARD };
 	input.ki = { key, NULL, KEYEVENTF_KEYUP, 0, NULL };
 	return SendInput(1, &input, sizeof(INPUT)) == 1;
 }
 
-bool SimInp::SendKbd(WORD key, DWORD delayMilli)
+bool SimInp::SendKbd(uint16_t key, uint32_t delayMilli)
 {
 	if (delayMilli)
 	{
@@ -55,38 +57,38 @@ void KeyCombo(const T& keys)
 	SendInput(size, input.get(), sizeof(INPUT));
 }
 
-void SimInp::KeyCombo(std::initializer_list<TCHAR> keys)
+void SimInp::KeyCombo(std::initializer_list<VKey> keys)
 {
 	::KeyCombo(keys);
 }
 
-void SimInp::KeyCombo(const std::vector<TCHAR>& keys)
+void SimInp::KeyCombo(const VKeyList& keys)
 {
 	::KeyCombo(keys);
 }
 
 
-void SimInp::SendKbd(const TCHAR* str, int len)
+void SimInp::SendKbd(const char* str, int len)
 {
 	for (UINT i = 0; i < len; i++)
 		SimInp::SendKbd(Keys::CharToVirtualKey(str[i]));
 }
 
-bool SimInp::SendKbdDownSC(WORD key, bool E0)
+bool SimInp::SendKbdDownSC(uint16_t key, bool E0)
 {
 	INPUT input{ INPUT_KEYBOARD };
 	input.ki = { 0, key, (E0 ? KEYEVENTF_EXTENDEDKEY : 0UL) | KEYEVENTF_SCANCODE, 0, NULL };
 	return SendInput(1, &input, sizeof(INPUT)) == 1;
 }
 
-bool SimInp::SendKbdUpSC(WORD key, bool E0)
+bool SimInp::SendKbdUpSC(uint16_t key, bool E0)
 {
 	INPUT input{ INPUT_KEYBOARD };
 	input.ki = { 0, key, (E0 ? KEYEVENTF_EXTENDEDKEY : 0UL) | KEYEVENTF_SCANCODE | KEYEVENTF_KEYUP, 0, NULL };
 	return SendInput(1, &input, sizeof(INPUT)) == 1;
 }
 
-bool SimInp::SendKbdSC(WORD key, bool E0, DWORD delayMilli)
+bool SimInp::SendKbdSC(uint16_t key, bool E0, uint32_t delayMilli)
 {
 	if (delayMilli)
 	{
@@ -103,7 +105,7 @@ bool SimInp::SendKbdSC(WORD key, bool E0, DWORD delayMilli)
 	}
 }
 
-void SimInp::SendKbdSC(const TCHAR* str, int len)
+void SimInp::SendKbdSC(const char* str, int len)
 {
 	for (UINT i = 0; i < len; i++)
 		SimInp::SendKbdSC(Keys::CharToScanCode(str[i]), false);
@@ -127,12 +129,12 @@ void KeyComboSC(const T& keys)
 	SendInput(size, input.get(), sizeof(INPUT));
 }
 
-void SimInp::KeyComboSC(std::initializer_list<std::pair<WORD, bool>> keys)
+void SimInp::KeyComboSC(std::initializer_list<std::pair<uint16_t, bool>> keys)
 {
 	::KeyComboSC(keys);
 }
 
-void SimInp::KeyComboSC(const std::vector<std::pair<WORD, bool>>& keys)
+void SimInp::KeyComboSC(const std::vector<std::pair<uint16_t, bool>>& keys)
 {
 	::KeyComboSC(keys);
 }
@@ -154,7 +156,7 @@ bool SimInp::SendClickUp(bool left, bool right, bool middle)
 	return SendInput(1, &input, sizeof(INPUT)) == 1;
 }
 
-bool SimInp::SendClick(bool left, bool right, bool middle, DWORD delayMilli)
+bool SimInp::SendClick(bool left, bool right, bool middle, uint32_t delayMilli)
 {
 	if (delayMilli)
 	{
@@ -187,7 +189,7 @@ bool SimInp::SendXClickUp(bool xButton1, bool xButton2)
 	return SendInput(1, &input, sizeof(INPUT)) == 1;
 }
 
-bool SimInp::SendXClick(bool xButton1, bool xButton2, DWORD delayMilli)
+bool SimInp::SendXClick(bool xButton1, bool xButton2, uint32_t delayMilli)
 {
 	if (delayMilli)
 	{
@@ -213,7 +215,7 @@ bool SimInp::SendMousePosition(int x, int y, bool absolute)
 	return SendInput(1, &input, sizeof(INPUT)) == 1;
 }
 
-void SimInp::MouseMove(int x, int y, DWORD duration, DWORD freq)
+void SimInp::MouseMove(int x, int y, uint32_t duration, uint32_t freq)
 {
 	const DWORD nLoops = ((float)duration / (float)freq) + 0.5f;
 	const float iX = (float)x / (float)nLoops,
@@ -238,4 +240,126 @@ bool SimInp::SendMouseScroll(int nClicks)
 	INPUT input{ INPUT_MOUSE };
 	input.mi = { 0, 0, (DWORD)(nClicks * WHEEL_DELTA), MOUSEEVENTF_WHEEL, 0, NULL };
 	return SendInput(1, &input, sizeof(INPUT)) == 1;
+}
+
+
+//The INPUT SendInput takes for a recorded event, false for a delay which injects nothing
+static bool MakeINPUT(const Input& it, INPUT& input)
+{
+	switch (it.GetUUID())
+	{
+	case KbdData::uuid:
+	{
+		const DWORD extended = (it.flags & KbdData::E0) ? KEYEVENTF_EXTENDEDKEY : 0UL;
+		const DWORD up = (it.flags & KbdData::DOWN) ? 0UL : KEYEVENTF_KEYUP;
+		input = { INPUT_KEYBOARD };
+		if (it.flags & KbdData::SC)
+			input.ki = { 0, it.key, extended | KEYEVENTF_SCANCODE | up, 0, NULL };
+		else
+			input.ki = { it.key, NULL, up, 0, NULL };
+		return true;
+	}
+	case MouseClickData::uuid:
+	{
+		const bool down = it.flags & MouseClickData::DOWN;
+		DWORD flags = 0;
+		if (it.flags & MouseClickData::LEFT)
+			flags |= down ? MOUSEEVENTF_LEFTDOWN : MOUSEEVENTF_LEFTUP;
+		if (it.flags & MouseClickData::RIGHT)
+			flags |= down ? MOUSEEVENTF_RIGHTDOWN : MOUSEEVENTF_RIGHTUP;
+		if (it.flags & MouseClickData::MIDDLE)
+			flags |= down ? MOUSEEVENTF_MIDDLEDOWN : MOUSEEVENTF_MIDDLEUP;
+		input = { INPUT_MOUSE };
+		input.mi = { 0, 0, NULL, flags, 0, NULL };
+		return true;
+	}
+	case MouseXClickData::uuid:
+	{
+		const DWORD data = ((it.flags & MouseXClickData::X1) ? XBUTTON1 : NULL) | ((it.flags & MouseXClickData::X2) ? XBUTTON2 : NULL);
+		input = { INPUT_MOUSE };
+		input.mi = { 0, 0, data, (DWORD)((it.flags & MouseXClickData::DOWN) ? MOUSEEVENTF_XDOWN : MOUSEEVENTF_XUP), 0, NULL };
+		return true;
+	}
+	case MouseMoveData::uuid:
+		input = { INPUT_MOUSE };
+		input.mi = { it.x, it.y, NULL, (DWORD)((it.flags & MouseMoveData::ABSOLUTE) ? MOUSEEVENTF_MOVE | MOUSEEVENTF_ABSOLUTE : MOUSEEVENTF_MOVE), 0, NULL };
+		return true;
+	case MouseScrollData::uuid:
+		input = { INPUT_MOUSE };
+		input.mi = { 0, 0, (DWORD)(it.x * WHEEL_DELTA), MOUSEEVENTF_WHEEL, 0, NULL };
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool SendInputSink::SendBatch(const Input* inputs, size_t count)
+{
+	//Reused so playback doesn't allocate once it has seen its largest batch
+	static thread_local std::vector<INPUT> batch;
+	batch.clear();
+
+	INPUT input;
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (MakeINPUT(inputs[i], input))
+			batch.push_back(input);
+	}
+
+	return batch.empty() || (SendInput((UINT)batch.size(), batch.data(), sizeof(INPUT)) == batch.size());
+}
+
+class CompiledINPUT : public InputSink::Compiled
+{
+public:
+	std::vector<INPUT> inputs;
+};
+
+std::unique_ptr<InputSink::Compiled> SendInputSink::Compile(const PlaybackPlan& plan) const
+{
+	auto compiled = std::make_unique<CompiledINPUT>();
+	compiled->inputs.resize(plan.GetEventCount());
+
+	//Batches only hold events that inject something, so every event fills its slot
+	const InputSpan events = plan.GetEvents();
+	for (const auto& it : plan.GetBatches())
+	{
+		for (size_t i = 0; i < it.count; ++i)
+			MakeINPUT(events[it.first + i], compiled->inputs[it.compiled + i]);
+	}
+	return compiled;
+}
+
+bool SendInputSink::SendCompiled(const Compiled& compiled, size_t first, size_t count)
+{
+	INPUT* inputs = const_cast<INPUT*>(static_cast<const CompiledINPUT&>(compiled).inputs.data()) + first;
+	return SendInput((UINT)count, inputs, sizeof(INPUT)) == count;
+}
+
+bool SendInputSink::SendKbd(uint16_t key, bool down, bool sc, bool E0)
+{
+	if (sc)
+		return down ? SimInp::SendKbdDownSC(key, E0) : SimInp::SendKbdUpSC(key, E0);
+
+	return down ? SimInp::SendKbdDown(key) : SimInp::SendKbdUp(key);
+}
+
+bool SendInputSink::SendClick(bool down, bool left, bool right, bool middle)
+{
+	return down ? SimInp::SendClickDown(left, right, middle) : SimInp::SendClickUp(left, right, middle);
+}
+
+bool SendInputSink::SendXClick(bool down, bool x1, bool x2)
+{
+	return down ? SimInp::SendXClickDown(x1, x2) : SimInp::SendXClickUp(x1, x2);
+}
+
+bool SendInputSink::SendMousePosition(int x, int y, bool absolute)
+{
+	return SimInp::SendMousePosition(x, y, absolute);
+}
+
+bool SendInputSink::SendMouseScroll(int nClicks)
+{
+	return SimInp::SendMouseScroll(nClicks);
 }
\ No newline at end of file
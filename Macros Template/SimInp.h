@@ -1,39 +1,58 @@
 #pragma once
-#include <Windows.h>
 #include <initializer_list>
 #include <vector>
+#include "Types.h"
+#include "InputSink.h"
 
 namespace SimInp
 {
 	//-Kbd Functions
 	//--VirtualKeyCode
-	bool SendKbdDown(WORD key);
-	bool SendKbdUp(WORD key);
-	bool SendKbd(WORD key, DWORD delayMilli = 0);
-	void KeyCombo(std::initializer_list<TCHAR> keys);
-	void KeyCombo(const std::vector<TCHAR>& keys);
-	void SendKbd(const TCHAR* str, int len);
+	bool SendKbdDown(uint16_t key);
+	bool SendKbdUp(uint16_t key);
+	bool SendKbd(uint16_t key, uint32_t delayMilli = 0);
+	void KeyCombo(std::initializer_list<VKey> keys);
+	void KeyCombo(const VKeyList& keys);
+	void SendKbd(const char* str, int len);
 
 	//--Scan Codes
-	bool SendKbdDownSC(WORD key, bool E0 = false);
-	bool SendKbdUpSC(WORD key, bool E0 = false);
-	bool SendKbdSC(WORD key, bool E0 = false, DWORD delayMilli = 0);
-	void KeyComboSC(std::initializer_list<std::pair<WORD, bool>> keys);
-	void KeyComboSC(const std::vector<std::pair<WORD, bool>>& keys);
-	void SendKbdSC(const TCHAR* str, int len);
+	bool SendKbdDownSC(uint16_t key, bool E0 = false);
+	bool SendKbdUpSC(uint16_t key, bool E0 = false);
+	bool SendKbdSC(uint16_t key, bool E0 = false, uint32_t delayMilli = 0);
+	void KeyComboSC(std::initializer_list<std::pair<uint16_t, bool>> keys);
+	void KeyComboSC(const std::vector<std::pair<uint16_t, bool>>& keys);
+	void SendKbdSC(const char* str, int len);
 
 	//-Mouse Functions
 	bool SendClickDown(bool left, bool right, bool middle);
 	bool SendClickUp(bool left, bool right, bool middle);
-	bool SendClick(bool left, bool right, bool middle, DWORD delayMilli = 0);
+	bool SendClick(bool left, bool right, bool middle, uint32_t delayMilli = 0);
 
 	bool SendXClickDown(bool xButton1, bool xButton2);
 	bool SendXClickUp(bool xButton1, bool xButton2);
-	bool SendXClick(bool xButton1, bool xButton2, DWORD delayMilli = 0);
+	bool SendXClick(bool xButton1, bool xButton2, uint32_t delayMilli = 0);
 
 	//If absolute x and y are normalized coordinates from 0 to 65,535
 	bool SendMousePosition(int x, int y, bool absolute = false);
-	void MouseMove(int x, int y, DWORD duration, DWORD freq);
+	void MouseMove(int x, int y, uint32_t duration, uint32_t freq);
 
 	bool SendMouseScroll(int nClicks);
-}
\ No newline at end of file
+}
+
+//Injects into the desktop session through SendInput
+class SendInputSink : public InputSink
+{
+public:
+	SendInputSink() = default;
+
+	bool SendKbd(uint16_t key, bool down, bool sc, bool E0) override;
+	bool SendClick(bool down, bool left, bool right, bool middle) override;
+	bool SendXClick(bool down, bool x1, bool x2) override;
+	bool SendMousePosition(int x, int y, bool absolute) override;
+	bool SendMouseScroll(int nClicks) override;
+	//One SendInput call for the whole batch
+	bool SendBatch(const Input* inputs, size_t count) override;
+	//Builds the INPUT array of a whole plan, so playing it only submits slices of it
+	std::unique_ptr<Compiled> Compile(const PlaybackPlan& plan) const override;
+	bool SendCompiled(const Compiled& compiled, size_t first, size_t count) override;
+};
\ No newline at end of file
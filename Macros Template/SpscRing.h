@@ -0,0 +1,110 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+//Bounded lock-free single producer / single consumer ring. Indices grow monotonically and
+//are masked into a power of two sized buffer; each side caches the other's index so the
+//shared cache lines are only touched when the cached view runs out.
+template<typename T>
+class SpscRing
+{
+public:
+	static constexpr size_t CACHE_LINE = 64;
+
+	explicit SpscRing(size_t capacity)
+		:
+		mask(RoundUp(capacity) - 1),
+		buffer(std::make_unique<T[]>(mask + 1))
+	{}
+
+	SpscRing(const SpscRing&) = delete;
+	SpscRing& operator=(const SpscRing&) = delete;
+
+	//Producer side, fails and counts an overflow when the ring is full
+	bool Push(const T& value)
+	{
+		const size_t h = head.load(std::memory_order_relaxed);
+		if (h - cachedTail > mask)
+		{
+			cachedTail = tail.load(std::memory_order_acquire);
+			if (h - cachedTail > mask)
+			{
+				overflows.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+		}
+
+		buffer[h & mask] = value;
+		head.store(h + 1, std::memory_order_release);
+
+		//cachedTail lags the consumer and overstates what is queued, so it only tells that the
+		//mark might have been passed. The actual tail is read before the mark is raised.
+		const size_t highMark = highWater.load(std::memory_order_relaxed);
+		if (h + 1 - cachedTail > highMark)
+		{
+			cachedTail = tail.load(std::memory_order_acquire);
+			const size_t used = h + 1 - cachedTail;
+			if (used > highMark)
+				highWater.store(used, std::memory_order_relaxed);
+		}
+		return true;
+	}
+
+	//Consumer side, copies up to maxCount elements and returns how many were taken
+	size_t PopBatch(T* out, size_t maxCount)
+	{
+		const size_t t = tail.load(std::memory_order_relaxed);
+		if (cachedHead == t)
+		{
+			cachedHead = head.load(std::memory_order_acquire);
+			if (cachedHead == t)
+				return 0;
+		}
+
+		const size_t count = (cachedHead - t) < maxCount ? (cachedHead - t) : maxCount;
+		for (size_t i = 0; i < count; ++i)
+			out[i] = buffer[(t + i) & mask];
+
+		tail.store(t + count, std::memory_order_release);
+		return count;
+	}
+
+	bool Empty() const
+	{
+		return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+	}
+
+	size_t Capacity() const
+	{
+		return mask + 1;
+	}
+	uint64_t GetOverflowCount() const
+	{
+		return overflows.load(std::memory_order_relaxed);
+	}
+	size_t GetHighWaterMark() const
+	{
+		return highWater.load(std::memory_order_relaxed);
+	}
+private:
+	static size_t RoundUp(size_t capacity)
+	{
+		size_t size = 2;
+		while (size < capacity)
+			size <<= 1;
+		return size;
+	}
+
+	const size_t mask;
+	const std::unique_ptr<T[]> buffer;
+
+	alignas(CACHE_LINE) std::atomic<size_t> head { 0 };
+	size_t cachedTail = 0;
+	std::atomic<uint64_t> overflows { 0 };
+	std::atomic<size_t> highWater { 0 };
+
+	alignas(CACHE_LINE) std::atomic<size_t> tail { 0 };
+	size_t cachedHead = 0;
+};
\ No newline at end of file
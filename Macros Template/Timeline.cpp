@@ -0,0 +1,37 @@
+#include "Timeline.h"
+#include <algorithm>
+
+void Timeline::Build(InputSpan events, uint64_t revision)
+{
+	this->revision = revision;
+	times.resize(events.size);
+
+	uint64_t time = 0;
+	for (size_t i = 0; i < events.size; ++i)
+	{
+		time += events[i].GetDelay();
+		times[i] = time;
+	}
+}
+
+bool Timeline::IsBuilt(uint64_t revision) const
+{
+	return this->revision == revision;
+}
+
+size_t Timeline::Seek(uint64_t time) const
+{
+	return size_t(std::lower_bound(times.begin(), times.end(), time) - times.begin());
+}
+uint64_t Timeline::GetTime(size_t index) const
+{
+	return times[index];
+}
+uint64_t Timeline::GetDuration() const
+{
+	return times.empty() ? 0 : times.back();
+}
+size_t Timeline::GetEventCount() const
+{
+	return times.size();
+}
\ No newline at end of file
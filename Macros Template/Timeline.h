@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "InputData.h"
+
+//When every event of a record is due, a prefix sum of their delays, so the event at a time is
+//found by binary search instead of adding up every delay before it. Built once per change of
+//the record, like its PlaybackPlan.
+class Timeline
+{
+public:
+	void Build(InputSpan events, uint64_t revision);
+	bool IsBuilt(uint64_t revision) const;
+
+	//Index of the first event due at or after time, the event count if there is none
+	size_t Seek(uint64_t time) const;
+	//Microseconds from the start of the record to the event, its own delay included
+	uint64_t GetTime(size_t index) const;
+	uint64_t GetDuration() const;
+	size_t GetEventCount() const;
+private:
+	std::vector<uint64_t> times;
+	uint64_t revision = 0;
+};
\ No newline at end of file
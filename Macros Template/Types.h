@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+//Platform neutral types used by the core in place of TCHAR/WORD/DWORD and RAWKEYBOARD/RAWMOUSE
+using VKey = unsigned char;
+using ScanCode = uint16_t;
+using VKeyList = std::vector<VKey>;
+
+//Virtual key codes the core refers to by name, the same values as the Windows VK_* codes.
+//Letters and digits are their upper case ASCII code.
+namespace VK
+{
+	constexpr VKey SHIFT	= 0x10;
+	constexpr VKey CONTROL	= 0x11;
+	constexpr VKey MENU		= 0x12;
+	constexpr VKey ESCAPE	= 0x1B;
+	constexpr VKey DOWN		= 0x28;
+	constexpr VKey F1		= 0x70;
+	constexpr VKey F2		= 0x71;
+	constexpr VKey F3		= 0x72;
+	constexpr VKey F4		= 0x73;
+	constexpr VKey LSHIFT	= 0xA0;
+	constexpr VKey RSHIFT	= 0xA1;
+	constexpr VKey LCONTROL	= 0xA2;
+	constexpr VKey RCONTROL	= 0xA3;
+	constexpr VKey LMENU	= 0xA4;
+	constexpr VKey RMENU	= 0xA5;
+}
+
+struct KbdEvent
+{
+	VKey vKey = 0;
+	ScanCode makeCode = 0;
+	bool down = false;
+	bool sys = false;	//WM_SYSKEYDOWN / WM_SYSKEYUP
+	bool E0 = false, E1 = false;
+	bool injected = false;	//Sent with SendInput, like the keys of a playing record
+};
+
+struct MouseEvent
+{
+	//Same values as the RI_MOUSE_* button flags
+	enum ButtonFlags : uint16_t
+	{
+		LEFT_DOWN	= 0x0001,
+		LEFT_UP		= 0x0002,
+		RIGHT_DOWN	= 0x0004,
+		RIGHT_UP	= 0x0008,
+		MIDDLE_DOWN	= 0x0010,
+		MIDDLE_UP	= 0x0020,
+		X1_DOWN		= 0x0040,
+		X1_UP		= 0x0080,
+		X2_DOWN		= 0x0100,
+		X2_UP		= 0x0200,
+		WHEEL		= 0x0400
+	};
+
+	int32_t x = 0, y = 0;
+	bool absolute = false;
+	uint16_t buttonFlags = 0;
+	int16_t wheelDelta = 0;
+};
+
+//Captured event as queued from the capture thread to the thread that processes it
+struct RawEvent
+{
+	enum Type : uint8_t
+	{
+		KBD,
+		MOUSE
+	};
+
+	Type type = KBD;
+	int64_t timestamp = 0;	//HiResClock nanoseconds, taken when the event was received
+	KbdEvent kbd;
+	MouseEvent mouse;
+};
\ No newline at end of file
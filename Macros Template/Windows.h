@@ -21,16 +21,20 @@ public:
 private:
 	LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam);
 
-	void MouseBIProc(const RAWMOUSE& mouse, DWORD delay);
-	void KbdBIProc(const RAWKEYBOARD& kbd, DWORD delay);
+	void MouseBIProc(const MouseEvent& mouse, int64_t timestamp);
+	void KbdBIProc(const KbdEvent& kbd, int64_t timestamp);
 
 	Styles styles;
 
 	std::unique_ptr<RawInp> rawInput;
 
+	SendInputSink sink;
 	Keys keys;
 	KeyComboRec comboRec;
 	RecordList recordList;
 	Ignorekeys ignoreKeys;
 	StringSet outStrings;
+	uint64_t droppedAtRecordStart = 0;
+	std::string droppedString;
+	std::string motionString;
 };
\ No newline at end of file
@@ -30,16 +30,64 @@ const TCHAR szTitle[] = _T("Macros");
 
 const TCHAR DIRECTORY[] = _T("Records");
 
-const TCHAR INSTRUCTIONS[] = _T("| SELECT / TOGGLE_REC - CTRL + F1 | SIM - CTRL + F2 | ADD - CTRL + MENU + A | DEL - CTRL + MENU + D | EXIT - CTRL + DOWN | ");
+const TCHAR INSTRUCTIONS[] = _T("| SELECT / TOGGLE_REC - CTRL + F1 | SIM / ABORT - CTRL + F2 | PAUSE / RESUME - CTRL + F3 | COALESCE MOTION - CTRL + F4 | ADD - CTRL + MENU + A | DEL - CTRL + MENU + D | EXIT - CTRL + DOWN | ");
 const TCHAR ADDINGRECORD[] = _T("Adding Record... waiting for key combination");
 const TCHAR DELETINGRECORD[] = _T("Deleting Record... waiting for key combination");
 const TCHAR RECORDING[] = _T("Recording....");
 const TCHAR SIMUALTINGRECORD[] = _T("Simulating Record...");
+const TCHAR PAUSEDRECORD[] = _T("Simulation Paused");
 const TCHAR CURRENTRECORD[] = _T("Current Record = ");
+const TCHAR DROPPEDEVENTS[] = _T("Input queue overflowed, events dropped while recording = ");
+const TCHAR COALESCINGMOTION[] = _T("Coalescing mouse motion");
+const TCHAR MOTIONCOALESCED[] = _T("Mouse moves recorded = ");
+
+enum class Command
+{
+	NONE,
+	TOGGLE_RECORDING,
+	SIMULATE,
+	PAUSE,
+	TOGGLE_COALESCING,
+	EXIT,
+	ADD_RECORD,
+	DELETE_RECORD
+};
+
+//Built in commands, matched in order against the held keys on every key event. Each fires
+//on the press of its last key.
+struct CommandKeys
+{
+	Command command;
+	KeyMask vKeys;
+	VKey key;
+};
+
+static constexpr CommandKeys COMMANDS[] =
+{
+	{ Command::TOGGLE_RECORDING, { VK::CONTROL, VK::F1 }, VK::F1 },
+	{ Command::SIMULATE, { VK::CONTROL, VK::F2 }, VK::F2 },
+	{ Command::PAUSE, { VK::CONTROL, VK::F3 }, VK::F3 },
+	{ Command::TOGGLE_COALESCING, { VK::CONTROL, VK::F4 }, VK::F4 },
+	{ Command::EXIT, { VK::CONTROL, /*VK::ESCAPE*/VK::DOWN }, VK::DOWN }, // for some reason a VK_ESCAPE with WM_KEYDOWN does not reach the message queue even with raw_input
+	{ Command::ADD_RECORD, { VK::CONTROL, VK::MENU, 'A' }, 'A' },
+	{ Command::DELETE_RECORD, { VK::CONTROL, VK::MENU, 'D' }, 'D' }
+};
+
+//The command whose keys are all held
+static const CommandKeys* FindCommand(const Keys& keys)
+{
+	for (const auto& it : COMMANDS)
+	{
+		if (keys.IsPressedCombo(it.vKeys))
+			return &it;
+	}
+	return nullptr;
+}
 
 MainWindow::MainWindow(HINSTANCE hInst)
 	:
-	Window(hInst, WNDPROCP::Function( &MainWindow::WndProc, this ))
+	Window(hInst, WNDPROCP::Function( &MainWindow::WndProc, this )),
+	recordList(sink)
 {}
 
 int WINAPI WinMain(HINSTANCE hInstance,
@@ -137,87 +185,82 @@ LRESULT CALLBACK MainWindow::WndProc(HWND hWnd, UINT message, WPARAM wParam, LPA
 	return 0;
 }
 
-void MainWindow::MouseBIProc(const RAWMOUSE& mouse, DWORD delay)
+void MainWindow::MouseBIProc(const MouseEvent& mouse, int64_t timestamp)
 {
 	if (recordList.IsRecording())
 	{
-		if (delay != 0)
-		{
-			Input* ptr = recordList.GetBack();
-			if (!ptr->AddDelay(delay))
-				recordList.AddEventToRecord<DelayData>(delay);
-		}
-
-		if (mouse.usFlags == MOUSE_MOVE_RELATIVE)
+		if (!mouse.absolute)
 		{
-			if ((bool)mouse.lLastX || (bool)mouse.lLastY)
-				recordList.AddEventToRecord<MouseMoveData>(mouse.lLastX, mouse.lLastY, false);
+			if ((bool)mouse.x || (bool)mouse.y)
+				recordList.AddRelativeMove(mouse.x, mouse.y, timestamp);
 		}
-		else if (mouse.usFlags & MOUSE_MOVE_ABSOLUTE)
+		else
 		{
-			recordList.AddEventToRecord<MouseMoveData>(mouse.lLastX, mouse.lLastY, true);
+			recordList.AddDelayUntil(timestamp);
+			recordList.AddEventToRecord<MouseMoveData>(mouse.x, mouse.y, true);
 		}
 
-		if (mouse.usButtonFlags & RI_MOUSE_LEFT_BUTTON_DOWN)
+		//Records a merged move before any button
+		if (mouse.buttonFlags)
+			recordList.AddDelayUntil(timestamp);
+
+		if (mouse.buttonFlags & MouseEvent::LEFT_DOWN)
 		{
 			recordList.AddEventToRecord<MouseClickData>(true, true, false, false);
 		}
-		else if (mouse.usButtonFlags & RI_MOUSE_LEFT_BUTTON_UP)
+		else if (mouse.buttonFlags & MouseEvent::LEFT_UP)
 		{
 			recordList.AddEventToRecord<MouseClickData>(false, true, false, false);
 		}
 
-		if (mouse.usButtonFlags & RI_MOUSE_RIGHT_BUTTON_DOWN)
+		if (mouse.buttonFlags & MouseEvent::RIGHT_DOWN)
 		{
 			recordList.AddEventToRecord<MouseClickData>(true, false, true, false);
 		}
-		else if (mouse.usButtonFlags & RI_MOUSE_RIGHT_BUTTON_UP)
+		else if (mouse.buttonFlags & MouseEvent::RIGHT_UP)
 		{
 			recordList.AddEventToRecord<MouseClickData>(false, false, true, false);
 		}
 
 
-		if (mouse.usButtonFlags & RI_MOUSE_WHEEL)
+		if (mouse.buttonFlags & MouseEvent::WHEEL)
 		{
-			recordList.AddEventToRecord<MouseScrollData>((short)mouse.usButtonData / WHEEL_DELTA);
+			recordList.AddEventToRecord<MouseScrollData>(mouse.wheelDelta / WHEEL_DELTA);
 		}
 
 
-		else if (mouse.usButtonFlags & RI_MOUSE_MIDDLE_BUTTON_DOWN)
+		else if (mouse.buttonFlags & MouseEvent::MIDDLE_DOWN)
 		{
 			recordList.AddEventToRecord<MouseClickData>(true, false, false, true);
 		}
-		else if (mouse.usButtonFlags & RI_MOUSE_MIDDLE_BUTTON_UP)
+		else if (mouse.buttonFlags & MouseEvent::MIDDLE_UP)
 		{
 			recordList.AddEventToRecord<MouseClickData>(false, false, false, true);
 		}
 
-		if (mouse.usButtonFlags & RI_MOUSE_BUTTON_4_DOWN) //side button 1
+		if (mouse.buttonFlags & MouseEvent::X1_DOWN) //side button 1
 		{
 			recordList.AddEventToRecord<MouseXClickData>(true, true, false);
 		}
-		else if (mouse.usButtonFlags & RI_MOUSE_BUTTON_4_UP)
+		else if (mouse.buttonFlags & MouseEvent::X1_UP)
 		{
 			recordList.AddEventToRecord<MouseXClickData>(false, true, false);
 		}
 
-		if (mouse.usButtonFlags & RI_MOUSE_BUTTON_5_DOWN) //side button 2
+		if (mouse.buttonFlags & MouseEvent::X2_DOWN) //side button 2
 		{
 			recordList.AddEventToRecord<MouseXClickData>(true, false, true);
 		}
-		else if (mouse.usButtonFlags & RI_MOUSE_BUTTON_5_UP)
+		else if (mouse.buttonFlags & MouseEvent::X2_UP)
 		{
 			recordList.AddEventToRecord<MouseXClickData>(false, false, true);
 		}
 	}
 }
 
-void MainWindow::KbdBIProc(const RAWKEYBOARD& kbd, DWORD delay)
+void MainWindow::KbdBIProc(const KbdEvent& kbd, int64_t timestamp)
 {
-	if ((kbd.Message == WM_KEYDOWN) || (kbd.Message == WM_SYSKEYDOWN))
-		keys.OnPress(kbd.VKey);
-	else if((kbd.Message == WM_KEYUP) || (kbd.Message == WM_SYSKEYUP))
-		keys.OnRelease(kbd.VKey);
+	keys.OnKey(kbd);
 
 	//if (/*!(bool)(kbd.Flags & RI_KEY_BREAK) && */(kbd.MakeCode == keys.VirtualKeyToScanCode(VK_TAB)))
 	//{
@@ -235,9 +278,9 @@ void MainWindow::KbdBIProc(const RAWKEYBOARD& kbd, DWORD delay)
 
 	if (comboRec.GetRecordType() == KeyComboRec::RECORDING)
 	{
-		if (kbd.Message == WM_KEYDOWN)
+		if (kbd.down && !kbd.sys)
 		{
-			comboRec.AddVKey(kbd.VKey);
+			comboRec.AddVKey(kbd.vKey);
 			return;
 		}
 		else if (comboRec.HasRecorded())
@@ -263,9 +306,9 @@ void MainWindow::KbdBIProc(const RAWKEYBOARD& kbd, DWORD delay)
 	}
 	else if (comboRec.GetRecordType() == KeyComboRec::DELETING)
 	{
-		if (kbd.Message == WM_KEYDOWN)
+		if (kbd.down && !kbd.sys)
 		{
-			comboRec.AddVKey(kbd.VKey);
+			comboRec.AddVKey(kbd.vKey);
 			return;
 		}
 		else if (comboRec.HasRecorded())
@@ -290,23 +333,45 @@ void MainWindow::KbdBIProc(const RAWKEYBOARD& kbd, DWORD delay)
 		}
 	}
 
+	//Every key event while a command's keys are held is swallowed, but the command only runs on
+	//a fresh press of its last key. Auto repeat would otherwise abort a playback just started or
+	//flip pause back and forth, and keys injected by the playback would reach it as commands.
+	const CommandKeys* found = FindCommand(keys);
+	if (found && (!kbd.down || kbd.injected || keys.IsRepeat() || (kbd.vKey != found->key)))
+		return;
+	const Command command = found ? found->command : Command::NONE;
+
 	// Select Record
-	if (keys.IsPressedCombo({ VK_CONTROL, VK_F1 }))
+	if (command == Command::TOGGLE_RECORDING)
 	{
 		if (recordList.IsRecording())
 		{
-			// Remove CTRL + F1 release from list
-			recordList.PopBack();
+			// Remove CTRL + F1 release from list, the delay before it goes with it
 			recordList.PopBack();
 
 			recordList.Save();
 
-			outStrings.RemoveString(RECORDING);
+			outStrings.Lock();
+			outStrings.RemoveStringNL(RECORDING);
+			const uint64_t dropped = rawInput->GetQueue().GetOverflowCount() - droppedAtRecordStart;
+			if (dropped != 0)
+			{
+				droppedString = DROPPEDEVENTS + std::to_string(dropped);
+				outStrings.AddStringNL(droppedString);
+			}
+			const auto motion = recordList.GetMotionStats();
+			if (motion.recorded != motion.moves)
+			{
+				motionString = MOTIONCOALESCED + std::to_string(motion.recorded) + _T(" of ") + std::to_string(motion.moves) +
+					_T(" (") + std::to_string(motion.recorded ? motion.moves / motion.recorded : 0) + _T("x fewer)");
+				outStrings.AddStringNL(motionString);
+			}
+			outStrings.Unlock();
 			Redraw();
 		}
-		else if (recordList.GetCurrentRecord() != RecordList::INVALID)
+		else if ((recordList.GetCurrentRecord() != RecordList::INVALID) && !recordList.IsSimulating())
 		{
-			ignoreKeys.SetKeys({ { VK_CONTROL, WM_KEYUP, true }, { VK_F1, WM_KEYUP, true } });
+			ignoreKeys.SetKeys({ { VK_CONTROL, false, true }, { VK_F1, false, true } });
 
 			const auto metrics = GetMetricsXY();
 
@@ -316,33 +381,91 @@ void MainWindow::KbdBIProc(const RAWKEYBOARD& kbd, DWORD delay)
 			int mx = (pt.x * USHRT_MAX) / metrics.first;
 			int my = (pt.y * USHRT_MAX) / metrics.second;
 
-			outStrings.AddString(RECORDING);
+			outStrings.Lock();
+			if (!droppedString.empty())
+			{
+				outStrings.RemoveStringNL(droppedString);
+				droppedString.clear();
+			}
+			if (!motionString.empty())
+			{
+				outStrings.RemoveStringNL(motionString);
+				motionString.clear();
+			}
+			outStrings.AddStringNL(RECORDING);
+			outStrings.Unlock();
 			Redraw();
 
+			droppedAtRecordStart = rawInput->GetQueue().GetOverflowCount();
 			recordList.StartRecording();
 			recordList.AddEventToRecord<MouseMoveData>(mx, my, true);
 		}
 		return;
 	}
 
-	// Simulate Record
-	if (keys.IsPressedCombo({ VK_CONTROL, VK_F2 }))
+	// Simulate / Abort Record
+	if (command == Command::SIMULATE)
 	{
-		if (recordList.HasRecorded() && !recordList.IsRecording())
+		if (recordList.IsSimulating())
+		{
+			recordList.AbortSimulation();
+		}
+		else if (recordList.HasRecorded() && !recordList.IsRecording())
 		{
 			outStrings.AddString(SIMUALTINGRECORD);
 			Redraw();
 
-			recordList.SimulateRecord();
+			// Runs on the player thread once the record finished or was aborted
+			recordList.SimulateRecord([this](bool completed)
+			{
+				outStrings.Lock();
+				outStrings.RemoveStringNL(SIMUALTINGRECORD);
+				outStrings.RemoveStringNL(PAUSEDRECORD);
+				outStrings.Unlock();
+				Redraw();
+			});
+		}
+		return;
+	}
+
+	// Pause / Resume Simulation
+	if (command == Command::PAUSE)
+	{
+		if (recordList.IsSimulationPaused())
+		{
+			recordList.ResumeSimulation();
+			outStrings.RemoveString(PAUSEDRECORD);
+			Redraw();
+		}
+		else if (recordList.IsSimulating())
+		{
+			recordList.PauseSimulation();
+			outStrings.AddString(PAUSEDRECORD);
+			Redraw();
+		}
+		return;
+	}
 
-			outStrings.RemoveString(SIMUALTINGRECORD);
+	// Coalesce mouse motion in the records made from now on
+	if (command == Command::TOGGLE_COALESCING)
+	{
+		if (!recordList.IsRecording())
+		{
+			auto coalescing = recordList.GetMotionCoalescing();
+			coalescing.enabled = !coalescing.enabled;
+			recordList.SetMotionCoalescing(coalescing);
+
+			if (coalescing.enabled)
+				outStrings.AddString(COALESCINGMOTION);
+			else
+				outStrings.RemoveString(COALESCINGMOTION);
 			Redraw();
 		}
 		return;
 	}
 
 	// Exit program
-	if (keys.IsPressedCombo({ VK_CONTROL, /*VK_ESCAPE*/VK_DOWN })) // for some reason a VK_ESCAPE with WM_KEYDOWN does not reach the message queue even with raw_input
+	if (command == Command::EXIT)
 	{
 		if (!(recordList.IsRecording() || recordList.IsSimulating()))
 		{
@@ -352,7 +475,7 @@ void MainWindow::KbdBIProc(const RAWKEYBOARD& kbd, DWORD delay)
 	}
 
 	// Add Record
-	if (keys.IsPressedCombo({ VK_CONTROL, VK_MENU, Keys::CharToVirtualKey(_T('A')) }))
+	if ((command == Command::ADD_RECORD) && !recordList.IsSimulating())
 	{
 		outStrings.AddString(ADDINGRECORD);
 		Redraw();
@@ -362,7 +485,7 @@ void MainWindow::KbdBIProc(const RAWKEYBOARD& kbd, DWORD delay)
 	}
 
 	// Delete record
-	if (keys.IsPressedCombo({ VK_CONTROL, VK_MENU, Keys::CharToVirtualKey(_T('D')) }))
+	if ((command == Command::DELETE_RECORD) && !recordList.IsSimulating())
 	{
 		outStrings.AddString(DELETINGRECORD);
 		Redraw();
@@ -371,7 +494,7 @@ void MainWindow::KbdBIProc(const RAWKEYBOARD& kbd, DWORD delay)
 		return;
 	}
 
-	if (recordList.SelectRecord(kbd) != RecordList::INVALID)
+	if (recordList.SelectRecord(kbd, keys, timestamp) != RecordList::INVALID)
 	{
 		if (previousRecord != recordList.GetCurrentRecord())
 		{
@@ -390,15 +513,9 @@ void MainWindow::KbdBIProc(const RAWKEYBOARD& kbd, DWORD delay)
 	{
 		if (!ignoreKeys.KeyIgnored(kbd))
 		{
-			if (delay != 0)
-			{
-				Input* ptr = recordList.GetBack();
-				if (!ptr->AddDelay(delay))
-					recordList.AddEventToRecord<DelayData>(delay);
-			}
-
-			recordList.AddEventToRecord<KbdData>(kbd.MakeCode, !(bool)(kbd.Flags & RI_KEY_BREAK), true, (bool)(kbd.Flags & RI_KEY_E0));
-			//recordList.AddEventToRecord<KbdData>(kbd.VKey, (kbd.Message == WM_KEYDOWN) || (kbd.Message == WM_SYSKEYDOWN), false);
+			recordList.AddDelayUntil(timestamp);
+			recordList.AddEventToRecord<KbdData>(kbd.makeCode, kbd.down, true, kbd.E0);
+			//recordList.AddEventToRecord<KbdData>(kbd.vKey, kbd.down, false);
 		}
 	}
 }
\ No newline at end of file